@@ -3,7 +3,326 @@
 // November 13, 2024
 
 #include <iostream>
+#include <iomanip>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <type_traits>
+
+/*
+    G_CheapCompare marks comparators that are cheap enough, and branch-
+    unpredictable enough, that G_Sort should partition with the branchless
+    block method. The stock functors opt in for arithmetic types below their
+    definitions.
+*/
+template <typename Compare>
+struct G_CheapCompare : std::false_type {};
+
+/*
+    G_Sort is a static class of sorting routines that work on a raw [first, last)
+    range with a comparator functor, where comp(a, b) is true if a belongs before
+    b. G_Array and the other containers sort through it.
+
+    introsort is a pattern-defeating quicksort: ninther pivots, insertion sort
+    for small partitions, a heapsort fallback after too many unbalanced
+    partitions, and branchless block partitioning for cheap comparators.
+    O(n log n) worst case, and close to O(n) on already sorted input.
+*/
+class G_Sort {
+public:
+    template <typename T, typename Compare>
+    static void introsort(T* first, T* last, Compare comp){
+        size_t n = last - first;
+        if (n < 2) return;
+        const bool branchless = std::is_arithmetic<T>::value && G_CheapCompare<Compare>::value;
+        introsort_loop<T, Compare, branchless>(first, last, comp, floor_log2(n), true);
+    }
+
+    template <typename T, typename Compare>
+    static void insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    template <typename T, typename Compare>
+    static void heap_sort(T* first, T* last, Compare comp){
+        size_t n = last - first;
+        for (size_t i = n / 2; i-- > 0;) sift_down(first, i, n, comp);
+        for (size_t end = n; end-- > 1;){
+            std::swap(first[0], first[end]);
+            sift_down(first, 0, end, comp);
+        }
+    }
+
+private:
+    static const size_t INSERTION_THRESHOLD = 24;
+    static const size_t NINTHER_THRESHOLD = 128;
+    static const size_t PARTIAL_INSERTION_LIMIT = 8;
+    static const size_t BLOCK_SIZE = 64;
+
+    static int floor_log2(size_t n){
+        int log = 0;
+        while (n >>= 1) log++;
+        return log;
+    }
+
+    // Restores the max-heap property below index root, in a heap of n elements.
+    template <typename T, typename Compare>
+    static void sift_down(T* heap, size_t root, size_t n, Compare comp){
+        T value = std::move(heap[root]);
+        size_t child;
+        while ((child = 2 * root + 1) < n){
+            if (child + 1 < n && comp(heap[child], heap[child + 1])) child++;
+            if (!comp(value, heap[child])) break;
+            heap[root] = std::move(heap[child]);
+            root = child;
+        }
+        heap[root] = std::move(value);
+    }
+
+    // Same as insertion_sort, but the element before first must be no greater
+    // than anything in the range, which lets the inner loop skip a bounds check.
+    template <typename T, typename Compare>
+    static void unguarded_insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    // Insertion sort that gives up after moving PARTIAL_INSERTION_LIMIT
+    // elements. Returns true if the range ended up sorted.
+    template <typename T, typename Compare>
+    static bool partial_insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return true;
+        size_t moved = 0;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+                moved += cur - sift;
+            }
+            if (moved > PARTIAL_INSERTION_LIMIT) return false;
+        }
+        return true;
+    }
+
+    // Sorts three elements in place so that *a <= *b <= *c.
+    template <typename T, typename Compare>
+    static void sort3(T* a, T* b, T* c, Compare comp){
+        if (comp(*b, *a)) std::swap(*a, *b);
+        if (comp(*c, *b)) std::swap(*b, *c);
+        if (comp(*b, *a)) std::swap(*a, *b);
+    }
+
+    // Partitions around the pivot at *first: smaller elements go left, equal
+    // and greater ones right. Returns the pivot's final position and whether
+    // the range was already partitioned.
+    template <typename T, typename Compare>
+    static std::pair<T*, bool> partition_right(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        // The pivot was a median, so some element >= pivot stops this scan.
+        while (comp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !comp(*--last, pivot));
+        else                    while (!comp(*--last, pivot));
+        bool alreadyPartitioned = first >= last;
+        while (first < last){
+            std::swap(*first, *last);
+            while (comp(*++first, pivot));
+            while (!comp(*--last, pivot));
+        }
+        T* pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return std::pair<T*, bool>(pivotPos, alreadyPartitioned);
+    }
+
+    // partition_right for cheap comparators. Comparison results are written
+    // into blocks of offsets instead of branched on, then misplaced elements
+    // are swapped in bulk (BlockQuicksort).
+    template <typename T, typename Compare>
+    static std::pair<T*, bool> partition_right_branchless(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        while (comp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !comp(*--last, pivot));
+        else                    while (!comp(*--last, pivot));
+        bool alreadyPartitioned = first >= last;
+        if (!alreadyPartitioned) {
+            std::swap(*first, *last);
+            first++;
+            unsigned char offsetsL[BLOCK_SIZE];
+            unsigned char offsetsR[BLOCK_SIZE];
+            T* baseL = first;
+            T* baseR = last;
+            size_t numL = 0, numR = 0, startL = 0, startR = 0;
+            while (first < last){
+                // Fill whichever offset block is empty, splitting what's left
+                // evenly if both are.
+                size_t unknown = last - first;
+                size_t splitL = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+                size_t splitR = numR == 0 ? unknown - splitL : 0;
+                if (splitL > BLOCK_SIZE) splitL = BLOCK_SIZE;
+                if (splitR > BLOCK_SIZE) splitR = BLOCK_SIZE;
+                for (size_t i = 0; i < splitL; i++){
+                    offsetsL[numL] = static_cast<unsigned char>(i);
+                    numL += !comp(*first, pivot);
+                    first++;
+                }
+                for (size_t i = 0; i < splitR;){
+                    offsetsR[numR] = static_cast<unsigned char>(++i);
+                    numR += comp(*--last, pivot);
+                }
+                size_t num = numL < numR ? numL : numR;
+                for (size_t i = 0; i < num; i++){
+                    std::swap(baseL[offsetsL[startL + i]], *(baseR - offsetsR[startR + i]));
+                }
+                numL -= num; numR -= num;
+                startL += num; startR += num;
+                if (numL == 0) { startL = 0; baseL = first; }
+                if (numR == 0) { startR = 0; baseR = last; }
+            }
+            // At most one block still has misplaced elements; move them to the
+            // boundary.
+            if (numL) {
+                while (numL--) std::swap(baseL[offsetsL[startL + numL]], *--last);
+                first = last;
+            }
+            if (numR) {
+                while (numR--) { std::swap(*(baseR - offsetsR[startR + numR]), *first); first++; }
+                last = first;
+            }
+        }
+        T* pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return std::pair<T*, bool>(pivotPos, alreadyPartitioned);
+    }
+
+    // Puts elements equal to the pivot at *first on the left. Used when the
+    // pivot equals the element before the range, so the left side is all equal
+    // and needs no further sorting. Returns the pivot's final position.
+    template <typename T, typename Compare>
+    static T* partition_left(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        while (comp(pivot, *--last));
+        if (last + 1 == end) while (first < last && !comp(pivot, *++first));
+        else                 while (!comp(pivot, *++first));
+        while (first < last){
+            std::swap(*first, *last);
+            while (comp(pivot, *--last));
+            while (!comp(pivot, *++first));
+        }
+        T* pivotPos = last;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
+
+    // Sorts [begin, end). badAllowed counts how many unbalanced partitions are
+    // tolerated before switching to heapsort. leftmost is false when the
+    // element before begin is known to be <= everything in the range.
+    template <typename T, typename Compare, bool Branchless>
+    static void introsort_loop(T* begin, T* end, Compare comp, int badAllowed, bool leftmost){
+        while (true){
+            size_t size = end - begin;
+            if (size < INSERTION_THRESHOLD) {
+                if (leftmost) insertion_sort(begin, end, comp);
+                else unguarded_insertion_sort(begin, end, comp);
+                return;
+            }
+
+            // Median of three, or Tukey's ninther for larger ranges, moved to *begin.
+            size_t s2 = size / 2;
+            if (size > NINTHER_THRESHOLD) {
+                sort3(begin, begin + s2, end - 1, comp);
+                sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+                sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+                sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+                std::swap(*begin, *(begin + s2));
+            }
+            else sort3(begin + s2, begin, end - 1, comp);
+
+            // Many equal elements: take them all out in one pass.
+            if (!leftmost && !comp(*(begin - 1), *begin)) {
+                begin = partition_left(begin, end, comp) + 1;
+                continue;
+            }
+
+            std::pair<T*, bool> result = Branchless ? partition_right_branchless(begin, end, comp)
+                                                    : partition_right(begin, end, comp);
+            T* pivotPos = result.first;
+            size_t sizeL = pivotPos - begin;
+            size_t sizeR = end - (pivotPos + 1);
+
+            if (sizeL < size / 8 || sizeR < size / 8) {
+                if (--badAllowed == 0) {
+                    heap_sort(begin, end, comp);
+                    return;
+                }
+                // Shuffle a few elements to break up whatever pattern caused
+                // the bad split.
+                if (sizeL >= INSERTION_THRESHOLD) {
+                    std::swap(*begin, *(begin + sizeL / 4));
+                    std::swap(*(pivotPos - 1), *(pivotPos - sizeL / 4));
+                    if (sizeL > NINTHER_THRESHOLD) {
+                        std::swap(*(begin + 1), *(begin + (sizeL / 4 + 1)));
+                        std::swap(*(begin + 2), *(begin + (sizeL / 4 + 2)));
+                        std::swap(*(pivotPos - 2), *(pivotPos - (sizeL / 4 + 1)));
+                        std::swap(*(pivotPos - 3), *(pivotPos - (sizeL / 4 + 2)));
+                    }
+                }
+                if (sizeR >= INSERTION_THRESHOLD) {
+                    std::swap(*(pivotPos + 1), *(pivotPos + (1 + sizeR / 4)));
+                    std::swap(*(end - 1), *(end - sizeR / 4));
+                    if (sizeR > NINTHER_THRESHOLD) {
+                        std::swap(*(pivotPos + 2), *(pivotPos + (2 + sizeR / 4)));
+                        std::swap(*(pivotPos + 3), *(pivotPos + (3 + sizeR / 4)));
+                        std::swap(*(end - 2), *(end - (1 + sizeR / 4)));
+                        std::swap(*(end - 3), *(end - (2 + sizeR / 4)));
+                    }
+                }
+            }
+            else {
+                // A balanced split that needed no swaps suggests sorted input;
+                // try to finish each side with a bounded insertion sort.
+                if (result.second && partial_insertion_sort(begin, pivotPos, comp)
+                                  && partial_insertion_sort(pivotPos + 1, end, comp)) return;
+            }
+
+            // Recurse into the left side and loop on the right.
+            introsort_loop<T, Compare, Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+    }
+};
 
 // Although technically a dynamic array, this should work alright for the required
 // "homemade vector" of this assignment.
@@ -13,13 +332,6 @@ private:
     T* array = new T[0];
     size_t size = 0;
 
-    // Helper function to swap elements
-    void swap(T& a, T& b) {
-        T temp = a;
-        a = b;
-        b = temp;
-    }
-
 public:
     // Adding to the array is done through the add_element function, which
     // abstracts away all the resizing done.
@@ -83,18 +395,10 @@ public:
     }
 
     // Sort function using a functor for comparison
-    // Time complexity O(n^2)? Not great...
+    // Introsort through G_Sort, O(n log n) worst case.
     template <typename Compare>
     void sort(Compare comp) {
-        if (size > 1) {
-            for (size_t i = 0; i < size - 1; i++) {
-                for (size_t j = 0; j < size - i - 1; j++) {
-                    if (!comp(array[j], array[j + 1])) {
-                        swap(array[j], array[j + 1]);
-                    }
-                }
-            }
-        }
+        G_Sort::introsort(array, array + size, comp);
     }
 };
 
@@ -128,8 +432,315 @@ struct AbsoluteValueComparison{
         return std::abs(a) < std::abs(b); // return true IF abs(a) greater than abs(b)
     }
 };
+// Arithmetic comparisons are cheap, so let G_Sort partition them branchlessly.
+template <typename T>
+struct G_CheapCompare<Ascending<T>> : std::is_arithmetic<T> {};
+template <typename T>
+struct G_CheapCompare<Descending<T>> : std::is_arithmetic<T> {};
+template <typename T>
+struct G_CheapCompare<AbsoluteValueComparison<T>> : std::is_arithmetic<T> {};
+
+/*
+    G_ExternalSort sorts binary files of T that are too big to fit in memory.
+    The input is read in runs that fill the memory budget, each run is sorted
+    with G_Sort::introsort (the same sort G_Array uses) and spilled to a temporary
+    file, then the runs are merged with a loser tree: each output element costs
+    one comparison per tree level. All file access goes through large
+    sequential buffers. At most MAX_FAN_IN runs are ever open: once that many
+    have been spilled, the smaller half is merged into one before the next
+    spill, and the final merge handles whatever is left.
+
+    T must be trivially copyable, since elements are written as raw bytes.
+*/
+template <typename T>
+class G_ExternalSort {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "G_ExternalSort writes elements as raw bytes");
+
+    // Most runs merged at once, and most spilled runs open at any time. Keeps
+    // each run's read buffer large and the file descriptors bounded.
+    static const size_t MAX_FAN_IN = 64;
+
+    // Timings and volumes of the last sort_file call.
+    struct Stats {
+        size_t elements = 0;
+        size_t runs = 0;
+        size_t mergePasses = 0;
+        double bytesSpilled = 0;   // run bytes written to temporary files
+        double bytesMerged = 0;    // bytes written by all merge passes
+        double spillSeconds = 0;   // reading, sorting and spilling the runs
+        double mergeSeconds = 0;
+    };
+
+    // memoryBytes is the budget for the run buffer, and later for the merge
+    // buffers.
+    G_ExternalSort(size_t memoryBytes = size_t(256) << 20) : memoryBytes(memoryBytes) {}
+
+    // Sorts the elements of the binary file inPath into outPath. comp is the
+    // same kind of functor G_Array::sort takes. Returns false, after printing
+    // why, if a file can't be opened, read or written, or if its size isn't a
+    // whole number of elements.
+    template <typename Compare>
+    bool sort_file(const std::string& inPath, const std::string& outPath, Compare comp){
+        stats = Stats();
+        std::FILE* in = std::fopen(inPath.c_str(), "rb");
+        if (!in) {
+            std::cout << "Couldn't open " << inPath << " for reading.\n";
+            return false;
+        }
+
+        // Phase 1: sorted runs, spilled to temporary files. Whenever
+        // MAX_FAN_IN runs are open, the smaller half is merged into one, so
+        // the number of open files never grows past that.
+        auto spillStart = std::chrono::steady_clock::now();
+        double compactSeconds = 0;
+        size_t runCapacity = memoryBytes / sizeof(T) > 0 ? memoryBytes / sizeof(T) : 1;
+        T* run = new T[runCapacity];
+        std::FILE* runs[MAX_FAN_IN];
+        size_t runSizes[MAX_FAN_IN];
+        size_t runCount = 0;
+        bool ok = true;
+        size_t got;
+        while (ok && (got = std::fread(run, sizeof(T), runCapacity, in)) > 0){
+            if (runCount == MAX_FAN_IN) {
+                auto compactStart = std::chrono::steady_clock::now();
+                ok = compact_runs(runs, runSizes, runCount, comp);
+                compactSeconds += seconds_since(compactStart);
+                if (!ok) break;
+            }
+            G_Sort::introsort(run, run + got, comp);
+            std::FILE* spill = std::tmpfile();
+            ok = spill && std::fwrite(run, sizeof(T), got, spill) == got;
+            if (ok) {
+                runs[runCount] = spill;
+                runSizes[runCount++] = got;
+                stats.runs++;
+                stats.elements += got;
+                stats.bytesSpilled += double(got) * sizeof(T);
+            }
+            else if (spill) std::fclose(spill);
+        }
+        delete[] run;
+        if (ok && std::ferror(in)) {
+            std::cout << "Error reading " << inPath << ".\n";
+            ok = false;
+        }
+        // fread leaves a trailing partial element unreported; the read position
+        // gives it away. (Unknown for pipes, where ftell fails.)
+        long end = std::ftell(in);
+        if (ok && end >= 0 && uint64_t(end) != uint64_t(stats.elements) * sizeof(T)) {
+            std::cout << inPath << " is " << end << " bytes, not a multiple of the " << sizeof(T) << "-byte element.\n";
+            ok = false;
+        }
+        std::fclose(in);
+        stats.spillSeconds = seconds_since(spillStart) - compactSeconds;
+
+        // Phase 2: at most MAX_FAN_IN runs are left, so one merge straight to
+        // the output finishes the job.
+        auto mergeStart = std::chrono::steady_clock::now();
+        if (ok) {
+            std::FILE* out = std::fopen(outPath.c_str(), "wb");
+            ok = out != nullptr;
+            if (ok && runCount == 1) ok = copy_run(runs[0], out);
+            else if (ok && runCount > 1) {
+                ok = merge_runs(runs, runCount, out, comp);
+                stats.mergePasses++;
+            }
+            if (out && std::fclose(out) != 0) ok = false;
+        }
+        for (size_t i = 0; i < runCount; i++) std::fclose(runs[i]);
+        stats.mergeSeconds = seconds_since(mergeStart) + compactSeconds;
+
+        if (!ok) std::cout << "External sort of " << inPath << " into " << outPath << " failed.\n";
+        return ok;
+    }
+
+    const Stats& get_stats() const { return stats; }
+
+    // Prints the spill and merge throughput of the last sort_file call.
+    void report(std::ostream& os = std::cout) const {
+        const double MB = 1024.0 * 1024.0;
+        os << std::fixed << std::setprecision(2);
+        os << "Sorted " << stats.elements << " elements in " << stats.runs << " runs.\n";
+        os << "Spill: " << stats.bytesSpilled / MB << " MB in " << stats.spillSeconds << " s ("
+           << (stats.spillSeconds > 0 ? stats.bytesSpilled / MB / stats.spillSeconds : 0) << " MB/s)\n";
+        os << "Merge: " << stats.mergePasses << " pass(es), " << stats.bytesMerged / MB << " MB in "
+           << stats.mergeSeconds << " s ("
+           << (stats.mergeSeconds > 0 ? stats.bytesMerged / MB / stats.mergeSeconds : 0) << " MB/s)\n";
+        os.unsetf(std::ios::fixed);
+    }
+
+private:
+    size_t memoryBytes;
+    Stats stats;
+
+    static double seconds_since(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // A buffered reader over one spilled run. A read error ends the run
+    // early and sets failed.
+    struct RunReader {
+        std::FILE* file;
+        T* buffer;
+        size_t capacity, count, position;
+        bool exhausted;
+        bool failed;
+
+        bool start(){
+            std::rewind(file);
+            return next_block();
+        }
+        bool next_block(){
+            count = std::fread(buffer, sizeof(T), capacity, file);
+            position = 0;
+            if (count < capacity && std::ferror(file)) failed = true;
+            exhausted = count == 0;
+            return !exhausted;
+        }
+        const T& current() const { return buffer[position]; }
+        void advance(){
+            if (++position == count) next_block();
+        }
+    };
+
+    // Copies a whole spilled run to out.
+    bool copy_run(std::FILE* run, std::FILE* out){
+        size_t capacity = memoryBytes / sizeof(T) > 0 ? memoryBytes / sizeof(T) : 1;
+        T* buffer = new T[capacity];
+        std::rewind(run);
+        bool ok = true;
+        size_t got;
+        while (ok && (got = std::fread(buffer, sizeof(T), capacity, run)) > 0){
+            ok = std::fwrite(buffer, sizeof(T), got, out) == got;
+        }
+        if (std::ferror(run)) ok = false;
+        delete[] buffer;
+        return ok;
+    }
+
+    // Merges the smaller half of the open runs into one new run, leaving
+    // runCount at MAX_FAN_IN / 2 + 1. Merging the smallest first keeps each
+    // element's number of merges near log base MAX_FAN_IN / 2 of the run count.
+    template <typename Compare>
+    bool compact_runs(std::FILE** runs, size_t* runSizes, size_t& runCount, Compare comp){
+        // Largest first, so the runs to merge end up at the back.
+        for (size_t i = 1; i < runCount; i++){
+            for (size_t j = i; j > 0 && runSizes[j - 1] < runSizes[j]; j--){
+                std::swap(runSizes[j - 1], runSizes[j]);
+                std::swap(runs[j - 1], runs[j]);
+            }
+        }
+        size_t keep = runCount - MAX_FAN_IN / 2;
+        std::FILE* merged = std::tmpfile();
+        bool ok = merged && merge_runs(runs + keep, runCount - keep, merged, comp);
+        size_t total = 0;
+        for (size_t i = keep; i < runCount; i++){
+            total += runSizes[i];
+            std::fclose(runs[i]);
+        }
+        stats.mergePasses++;
+        runCount = keep;
+        if (!ok) {
+            if (merged) std::fclose(merged);
+            return false;
+        }
+        runs[runCount] = merged;
+        runSizes[runCount++] = total;
+        return true;
+    }
+
+    // k-way merge of runs into out through a loser tree. Node 0 holds the
+    // index of the current winner; nodes 1..k-1 hold the loser of the match
+    // played there. Ties go to the earlier run.
+    template <typename Compare>
+    bool merge_runs(std::FILE** files, size_t k, std::FILE* out, Compare comp){
+        // Split the memory between k input buffers and one output buffer.
+        size_t blockCapacity = memoryBytes / sizeof(T) / (k + 1);
+        if (blockCapacity < 1024) blockCapacity = 1024;
+        RunReader* readers = new RunReader[k];
+        T* storage = new T[blockCapacity * (k + 1)];
+        T* outBuffer = storage + blockCapacity * k;
+        for (size_t i = 0; i < k; i++){
+            readers[i] = RunReader{files[i], storage + blockCapacity * i, blockCapacity, 0, 0, true, false};
+            readers[i].start();
+        }
+
+        // beats(a, b): run a's current element goes out before run b's.
+        // Index k is a sentinel that beats everything, used while building.
+        auto beats = [&](size_t a, size_t b){
+            if (a == k) return true;
+            if (b == k) return false;
+            if (readers[a].exhausted) return false;
+            if (readers[b].exhausted) return true;
+            if (comp(readers[a].current(), readers[b].current())) return true;
+            if (comp(readers[b].current(), readers[a].current())) return false;
+            return a < b;
+        };
+        size_t* tree = new size_t[k];
+        for (size_t i = 0; i < k; i++) tree[i] = k;
+        // Plays run s up from its leaf, leaving losers behind.
+        auto replay = [&](size_t s){
+            for (size_t node = (s + k) / 2; node > 0; node /= 2){
+                if (beats(tree[node], s)) std::swap(s, tree[node]);
+            }
+            tree[0] = s;
+        };
+        for (size_t s = k; s-- > 0;) replay(s);
+
+        bool ok = true;
+        size_t pending = 0;
+        while (ok && !readers[tree[0]].exhausted){
+            size_t winner = tree[0];
+            outBuffer[pending++] = readers[winner].current();
+            if (pending == blockCapacity) {
+                ok = std::fwrite(outBuffer, sizeof(T), pending, out) == pending;
+                stats.bytesMerged += double(pending) * sizeof(T);
+                pending = 0;
+            }
+            readers[winner].advance();
+            replay(winner);
+        }
+        if (ok && pending) {
+            ok = std::fwrite(outBuffer, sizeof(T), pending, out) == pending;
+            stats.bytesMerged += double(pending) * sizeof(T);
+        }
+        if (std::fflush(out) != 0) ok = false;
+        for (size_t i = 0; i < k; i++){
+            if (readers[i].failed) ok = false;
+        }
+
+        delete[] tree;
+        delete[] storage;
+        delete[] readers;
+        return ok;
+    }
+};
+
+// Sorts a binary file of ints that may be larger than memory, e.g.
+//     ./CustomSort numbers.bin sorted.bin 512 desc
+// asc (the default) writes smallest first and desc largest first. The functor
+// names are the other way round: Ascending puts the larger value first.
+int external_sort_main(int argc, char* argv[]){
+    std::string inPath = argv[1];
+    std::string outPath = argv[2];
+    size_t memoryMB = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+    std::string order = argc > 4 ? argv[4] : "asc";
+    if (memoryMB == 0) memoryMB = 1;
+
+    G_ExternalSort<int> sorter(memoryMB << 20);
+    bool ok;
+    if (order == "desc") ok = sorter.sort_file(inPath, outPath, Ascending<int>());
+    else if (order == "abs") ok = sorter.sort_file(inPath, outPath, AbsoluteValueComparison<int>());
+    else ok = sorter.sort_file(inPath, outPath, Descending<int>());
+    if (ok) sorter.report();
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[]){
+    // Given an input and output file, run the external sort instead of the demo.
+    if (argc >= 3) return external_sort_main(argc, argv);
 
-int main(){
     G_Array<int> numbers;
     numbers.add_element(5);
     numbers.add_element(-10);
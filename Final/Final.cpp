@@ -6,6 +6,9 @@
 #include <iomanip>
 #include <chrono>
 #include <algorithm> // used for sorting population by fitness.
+#include <cstdint>
+#include <ctime>
+#include <atomic>
 
 const int GENERATIONS = 2000; // How many generations to simulate
 const int NUM_BOTS = 200; // size of the population. Must be even.
@@ -15,7 +18,57 @@ const int BATT_LIKELIHOOD = 40; // How likely is a tile to be a battery
 const int MUT_RATE = 5; // percentage of gene shuffles that incur a mutation
 
 /*
-    A singleton random number generator
+    xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1,
+    and a few shifts, rotates and multiplies per 64-bit output. The state is
+    filled through SplitMix64, so any seed (0 included) gives a good state.
+    It meets the UniformRandomBitGenerator requirements, so <random>
+    distributions and std::shuffle accept it.
+*/
+class G_Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit G_Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull){
+        this->seed(seed);
+    }
+    void seed(uint64_t value){
+        for (int i = 0; i < 4; i++) state[i] = splitmix64(value);
+    }
+
+    uint64_t operator()(){
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Steps x and returns a well-mixed 64-bit value.
+    static uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr uint64_t min(){ return 0; }
+    static constexpr uint64_t max(){ return UINT64_MAX; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+    uint64_t state[4];
+};
+
+/*
+    A singleton random number generator. Map generation and mutation draw
+    millions of numbers, so it uses G_Xoshiro256 rather than std::rand, with one
+    engine per thread.
 */
 class RandNo {
 public:
@@ -31,12 +84,35 @@ public:
     }
     // Method to generate a random integer between min and max
     int random_int(int min, int max) const {
-        return min + rand() % (max - min + 1);
+        uint64_t range = uint64_t(int64_t(max) - min) + 1;
+        return int(min + int64_t(bounded(engine(), range)));
     }
 private:
+    // Lemire's method: a uniform value below range from the top of a 32x32 bit
+    // product, redrawing only when the low half lands in the short biased
+    // stretch. The division that finds that stretch runs only on the rare
+    // draws that might be in it.
+    static uint64_t bounded(G_Xoshiro256& source, uint64_t range){
+        uint64_t product = (source() >> 32) * range;
+        if (uint32_t(product) < range) {
+            uint32_t threshold = uint32_t((uint64_t(1) << 32) % range);
+            while (uint32_t(product) < threshold) product = (source() >> 32) * range;
+        }
+        return product >> 32;
+    }
+
     // Private constructor to prevent instantiation
-    RandNo() {
-        std::srand(static_cast<unsigned int>(std::time(0))); // Seed the random number generator
+    RandNo() {}
+    // Each thread seeds its engine from the clock mixed with a per-thread
+    // ordinal, so no two threads share a state.
+    static G_Xoshiro256& engine() {
+        static const uint64_t seed = static_cast<uint64_t>(std::time(0));
+        static std::atomic<uint64_t> nextOrdinal{0};
+        thread_local G_Xoshiro256 local = [] {
+            uint64_t ordinal = nextOrdinal.fetch_add(1);
+            return G_Xoshiro256(seed ^ G_Xoshiro256::splitmix64(ordinal));
+        }();
+        return local;
     }
 };
 
@@ -443,11 +519,15 @@ int main(){
         averageGenerationsPerGeneration[generations] = averageGenerationsSurvived / NUM_BOTS;
         averageEnergyHarvestedPerGeneration[generations] = averageEnergyHarvested / NUM_BOTS;
 
-        // Sort bots by fitness using std::sort and a lamba defined descending sort
-        // I would have written a simple sort myself, but this array of 200 elements
-        // will be sorted 100 times, and performance felt important.
-        std::sort(population, population + NUM_BOTS, [](const Robot* a, const Robot* b) {
-            return a->get_energy_harvested() > b->get_energy_harvested();
+        // Sort bots by fitness using std::partial_sort and a lamba defined descending sort
+        // Only the surviving top half needs to be in order (it decides the breeding
+        // pairs), so the bottom half is left unsorted rather than fully sorting.
+        // Bots with equal energy are ordered by ID, older first. Neither sort is
+        // stable, so without that, which tied bots survive and how they pair
+        // would depend on the algorithm.
+        std::partial_sort(population, population + NUM_BOTS / 2, population + NUM_BOTS, [](const Robot* a, const Robot* b) {
+            if (a->get_energy_harvested() != b->get_energy_harvested()) return a->get_energy_harvested() > b->get_energy_harvested();
+            return a->get_ID() < b->get_ID();
         });
 
         // Breed highest performing bots into empty pop slots
@@ -8,6 +8,10 @@
 #include <iomanip>
 #include <chrono>
 #include <iomanip>
+#include <string_view>
+#include <cstdint>
+#include <ctime>
+#include <atomic>
 
 // Constants for RNG
 const int BOREDOM_MIN_REDUCTION = 4;
@@ -159,9 +163,57 @@ public:
         std::cout << "Completed component test of G_Array\n\n";
     }
 };
+/*
+    xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1,
+    and a few shifts, rotates and multiplies per 64-bit output. The state is
+    filled through SplitMix64, so any seed (0 included) gives a good state.
+    It meets the UniformRandomBitGenerator requirements, so <random>
+    distributions and std::shuffle accept it.
+*/
+class G_Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit G_Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull){
+        this->seed(seed);
+    }
+    void seed(uint64_t value){
+        for (int i = 0; i < 4; i++) state[i] = splitmix64(value);
+    }
+
+    uint64_t operator()(){
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Steps x and returns a well-mixed 64-bit value.
+    static uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr uint64_t min(){ return 0; }
+    static constexpr uint64_t max(){ return UINT64_MAX; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+    uint64_t state[4];
+};
+
 /*
     A singleton random number generator that provides multiple methods for creating
-    randomness
+    randomness. Backed by G_Xoshiro256, one engine per thread, instead of std::rand.
 */
 class RandNo {
 public:
@@ -172,7 +224,7 @@ public:
     friend std::istream& operator>>(std::istream& is, RandNo& rng) {
         int seed;
         is >> seed;
-        std::srand(static_cast<unsigned int>(seed));
+        rng.reseed(static_cast<uint64_t>(seed));
         return is;
     }
 
@@ -180,20 +232,29 @@ public:
     // Once RandNo is made, its static nature keeps it present
     // in only one place.
     static RandNo& get_instance() {
-        Logger l = Logger("get_instance");
         static RandNo instance;
         return instance;
     }
 
+    // Sets the seed for every thread. A thread's sequence depends on the seed
+    // and on how many threads first drew a number before it did.
+    void reseed(uint64_t seed){
+        baseSeed.store(seed, std::memory_order_relaxed);
+        epoch.fetch_add(1, std::memory_order_release);
+    }
+
     // Method to generate a random integer between min and max
     int random_int(int min, int max) {
-        Logger l = Logger("random_int");
-        return min + rand() % (max - min + 1);
+        uint64_t range = uint64_t(int64_t(max) - min) + 1;
+        return int(min + int64_t(bounded(engine(), range)));
     }
     // Method to generate a random floating point value between min and max
     float random_float(float min, float max) {
-        Logger l = Logger("random_float");
-        return min + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+        return min + unit_float(uint32_t(engine()() >> 32)) * (max - min);
+    }
+    // Raw 64 random bits from this thread's engine.
+    uint64_t next_u64() {
+        return engine()();
     }
 
     void ComponentTest(){
@@ -204,10 +265,127 @@ public:
     }
 
 private:
+    struct ThreadState {
+        G_Xoshiro256 engine;
+        uint64_t epoch = 0;
+        uint64_t ordinal = nextOrdinal.fetch_add(1, std::memory_order_relaxed);
+    };
+    inline static std::atomic<uint64_t> baseSeed{0};
+    // Bumped on every reseed; a thread whose copy is stale reseeds itself.
+    inline static std::atomic<uint64_t> epoch{0};
+    inline static std::atomic<uint64_t> nextOrdinal{0};
+
+    static G_Xoshiro256& engine(){
+        thread_local ThreadState local;
+        uint64_t current = epoch.load(std::memory_order_acquire);
+        if (local.epoch != current) {
+            // Mixing the ordinal into the seed costs the same for every
+            // thread, however many came before it.
+            uint64_t ordinal = local.ordinal;
+            local.engine.seed(baseSeed.load(std::memory_order_relaxed) ^ G_Xoshiro256::splitmix64(ordinal));
+            local.epoch = current;
+        }
+        return local.engine;
+    }
+
+    // Lemire's method: a uniform value below range from the top of a 32x32 bit
+    // product, redrawing only when the low half lands in the short biased
+    // stretch. The division that finds that stretch runs only on the rare
+    // draws that might be in it.
+    static uint64_t bounded(G_Xoshiro256& source, uint64_t range){
+        uint64_t product = (source() >> 32) * range;
+        if (uint32_t(product) < range) {
+            uint32_t threshold = uint32_t((uint64_t(1) << 32) % range);
+            while (uint32_t(product) < threshold) product = (source() >> 32) * range;
+        }
+        return product >> 32;
+    }
+    // 24 random bits scaled into [0, 1); every result is an exact float.
+    static float unit_float(uint32_t bits){
+        return float(int32_t(bits >> 8)) * (1.0f / 16777216.0f);
+    }
+
     // Private constructor to prevent instantiation
     RandNo() {
         Logger l = Logger("RandNo Constructor");
-        std::srand(static_cast<unsigned int>(std::time(0))); // Seed the random number generator
+        reseed(static_cast<uint64_t>(std::time(0))); // Seed the random number generator
+    }
+};
+/*
+    G_PerfectHash is a keyword table built entirely at compile time. The
+    constructor searches for a hash seed under which every keyword lands in
+    its own slot, so find() costs one hash and one string compare and returns
+    the keyword's position in the list (or -1). That position can index an
+    array of handlers or be switched on directly:
+
+        static constexpr std::string_view COMMANDS[] = {"PLAY", "FEED", "QUIT"};
+        static constexpr G_PerfectHash commandTable(COMMANDS);
+        switch (commandTable.find(command)) { ... }
+
+    The table has at least four slots per keyword, which keeps the seed
+    search short for lists of up to a few dozen words. If no seed works the
+    constructor throws, which fails the build rather than the program.
+*/
+template <size_t N>
+class G_PerfectHash {
+public:
+    // The smallest power of two with at least four slots per keyword.
+    static constexpr size_t SLOTS = []{
+        size_t size = 8;
+        while (size < 4 * N) size *= 2;
+        return size;
+    }();
+
+    constexpr G_PerfectHash(const std::string_view (&keywords)[N]){
+        for (size_t i = 0; i < N; i++) words[i] = keywords[i];
+        for (uint32_t candidate = 0; candidate < MAX_SEED; candidate++){
+            if (try_seed(candidate)) {
+                seed = candidate;
+                return;
+            }
+        }
+        throw "G_PerfectHash: no collision-free seed for these keywords";
+    }
+
+    // Position of word in the keyword list, or -1 if it isn't one.
+    constexpr int find(std::string_view word) const {
+        int index = slots[hash(seed, word) & (SLOTS - 1)];
+        return index >= 0 && words[index] == word ? index : -1;
+    }
+    constexpr bool contains(std::string_view word) const {
+        return find(word) != -1;
+    }
+    constexpr std::string_view keyword(size_t index) const {
+        return words[index];
+    }
+    constexpr size_t size() const {
+        return N;
+    }
+
+private:
+    static const uint32_t MAX_SEED = 1 << 16;
+
+    std::string_view words[N] = {};
+    int slots[SLOTS] = {};
+    uint32_t seed = 0;
+
+    // Seeded FNV-1a with a final mix so the low bits depend on every byte.
+    static constexpr uint32_t hash(uint32_t seed, std::string_view word){
+        uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (char c : word) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        return h;
+    }
+    constexpr bool try_seed(uint32_t candidate){
+        for (size_t i = 0; i < SLOTS; i++) slots[i] = -1;
+        for (size_t i = 0; i < N; i++){
+            int& slot = slots[hash(candidate, words[i]) & (SLOTS - 1)];
+            if (slot != -1) return false;
+            slot = static_cast<int>(i);
+        }
+        return true;
     }
 };
 
@@ -215,6 +393,21 @@ private:
     THE FOLLOWING CLASSES AND DATA ARE DESIGNED FOR USE IN THIS PROGRAM
 */
 
+// Every command the program understands. The enum follows the order of the
+// list, so commandTable.find() returns the command's enum value.
+static constexpr std::string_view COMMANDS[] = {
+    "PLAY", "FEED", "LISTEN", "QUIT", "BREED", "HELP", "VIEW", "RENAME", "GETNEW"
+};
+enum Command { CMD_PLAY, CMD_FEED, CMD_LISTEN, CMD_QUIT, CMD_BREED, CMD_HELP, CMD_VIEW, CMD_RENAME, CMD_GETNEW, CMD_COUNT };
+static_assert(sizeof(COMMANDS) / sizeof(COMMANDS[0]) == CMD_COUNT, "COMMANDS and the Command enum must list the same commands");
+static constexpr G_PerfectHash commandTable(COMMANDS);
+// Spelled out per command, so swapping two entries in COMMANDS fails to build.
+static_assert(commandTable.find("PLAY") == CMD_PLAY && commandTable.find("FEED") == CMD_FEED &&
+              commandTable.find("LISTEN") == CMD_LISTEN && commandTable.find("QUIT") == CMD_QUIT &&
+              commandTable.find("BREED") == CMD_BREED && commandTable.find("HELP") == CMD_HELP &&
+              commandTable.find("VIEW") == CMD_VIEW && commandTable.find("RENAME") == CMD_RENAME &&
+              commandTable.find("GETNEW") == CMD_GETNEW, "COMMANDS must be in the Command enum's order");
+
 // Specification C2 - Creature class
 // Specification B2 - Virtual Class Creature
 class Creature {
@@ -419,11 +612,12 @@ int main(){
             if (!inputStream.eof()) target += ' ';
         }
     
+        int commandId = commandTable.find(command);
         int playOrFeed = 0;
         Creature *targetCreature = get_referenced_creature(creatureCollection, target);
 
         bool nonTargetCommand = false;
-        if (command == "HELP"){
+        if (commandId == CMD_HELP){
             std::cout << "Available Commands:\n";
             std::cout << "Play\t:\tplay with target hokeemon, lowering their boredom.\n";
             std::cout << "Feed\t:\tfeed target hokeemon, raising their hunger.\n";
@@ -434,17 +628,17 @@ int main(){
             std::cout << "Getnew\t:\tget a new random hokeemon.\n";
             nonTargetCommand = true;
         }
-        else if (command == "QUIT"){
+        else if (commandId == CMD_QUIT){
             programRunning = false;
             nonTargetCommand = true;
         }
-        else if (command == "VIEW"){
+        else if (commandId == CMD_VIEW){
             for(int i = 0; i < creatureCollection.length(); i++){
                 std::cout << creatureCollection[i]->get_name() << '\n';
             }
             nonTargetCommand = true;
         }
-        else if (command == "GETNEW"){
+        else if (commandId == CMD_GETNEW){
             Creature* newCreature;
             if(RandNo::get_instance().random_int(0, 1)){
                 newCreature = new IBoredCreature;
@@ -465,23 +659,23 @@ int main(){
             continue;
         }
         // act on user command
-        if (command == "LISTEN"){ // Listen
+        if (commandId == CMD_LISTEN){ // Listen
             std::cout << *targetCreature;
         }
-        else if (command == "PLAY") {
+        else if (commandId == CMD_PLAY) {
             targetCreature->play();
             playOrFeed = 1;
         }
-        else if (command == "FEED") {
+        else if (commandId == CMD_FEED) {
             targetCreature->feed();
             playOrFeed = 2;
         }
         // Specification A1 - Critter Name
-        else if (command == "RENAME") {
+        else if (commandId == CMD_RENAME) {
             std::cout << "What should '" << targetCreature->get_name() << "''s new name be?\n";
             targetCreature->set_name(capital_input());
         }
-        else if (command == "BREED"){
+        else if (commandId == CMD_BREED){
             std::cout << "Which creature would you like to breed " << targetCreature->get_name() << " with?\n";
             Creature* secondTarget = get_referenced_creature(creatureCollection, capital_input());
             if (secondTarget != nullptr){
@@ -560,16 +754,7 @@ bool validate_input(std::string userInput){
     std::istringstream inputStream(userInput);
     std::string command;
     inputStream >> command;
-    if (command == "PLAY") return true; // Play
-    if (command == "FEED") return true; // Feed
-    if (command == "LISTEN") return true; // Listen
-    if (command == "QUIT") return true; // Quit
-    if (command == "BREED") return true; // Breed
-    if (command == "HELP") return true; // Help
-    if (command == "VIEW") return true; // View collection
-    if (command == "RENAME") return true; // Rename
-    if (command == "GETNEW") return true; // Get New Creature
-    return false;
+    return commandTable.contains(command); // Any of the COMMANDS
 }
 
 void program_greeting(){
@@ -8,6 +8,9 @@
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
+#include <cstdint>
+#include <ctime>
+#include <atomic>
 #include <iomanip>
 
 
@@ -119,6 +122,16 @@ public:
         Logger l = Logger("length");
         return size;
     }
+    // Returns the index of the first element for which pred is true, or -1.
+    // Reads the array directly so a search doesn't log every access.
+    template <typename Predicate>
+    int find_if(Predicate pred){
+        Logger l = Logger("find_if");
+        for (size_t i = 0; i < size; i++){
+            if (pred(array[i])) return static_cast<int>(i);
+        }
+        return -1;
+    }
     void ComponentTest(){
         std::cout << "Beginning Component testing of G_Array class template.\n";
         std::cout << "Length: " << length() << '\n';
@@ -207,7 +220,56 @@ public:
     }
 };
 
+/*
+    xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1,
+    and a few shifts, rotates and multiplies per 64-bit output. The state is
+    filled through SplitMix64, so any seed (0 included) gives a good state.
+    It meets the UniformRandomBitGenerator requirements, so <random>
+    distributions and std::shuffle accept it.
+*/
+class G_Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit G_Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull){
+        this->seed(seed);
+    }
+    void seed(uint64_t value){
+        for (int i = 0; i < 4; i++) state[i] = splitmix64(value);
+    }
+
+    uint64_t operator()(){
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Steps x and returns a well-mixed 64-bit value.
+    static uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    static constexpr uint64_t min(){ return 0; }
+    static constexpr uint64_t max(){ return UINT64_MAX; }
+
+private:
+    static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+    uint64_t state[4];
+};
+
 // Specification B2 -RandNo Class
+// Backed by G_Xoshiro256, one engine per thread, instead of std::rand.
 class RandNo {
 public:
     // Deleting the ability to copy instances or set instances equal to another
@@ -218,7 +280,7 @@ public:
     friend std::istream& operator>>(std::istream& is, RandNo& rng) {
         int seed;
         is >> seed;
-        std::srand(static_cast<unsigned int>(seed));
+        rng.reseed(static_cast<uint64_t>(seed));
         return is;
     }
 
@@ -226,20 +288,29 @@ public:
     // Once RandNo is made, its static nature keeps it present
     // in only one place.
     static RandNo& get_instance() {
-        Logger l = Logger("get_instance");
         static RandNo instance;
         return instance;
     }
 
+    // Sets the seed for every thread. A thread's sequence depends on the seed
+    // and on how many threads first drew a number before it did.
+    void reseed(uint64_t seed){
+        baseSeed.store(seed, std::memory_order_relaxed);
+        epoch.fetch_add(1, std::memory_order_release);
+    }
+
     // Method to generate a random integer between min and max
     int random_int(int min, int max) {
-        Logger l = Logger("random_int");
-        return min + rand() % (max - min + 1);
+        uint64_t range = uint64_t(int64_t(max) - min) + 1;
+        return int(min + int64_t(bounded(engine(), range)));
     }
     // Method to generate a random floating point value between min and max
     float random_float(float min, float max) {
-        Logger l = Logger("random_float");
-        return min + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+        return min + unit_float(uint32_t(engine()() >> 32)) * (max - min);
+    }
+    // Raw 64 random bits from this thread's engine.
+    uint64_t next_u64() {
+        return engine()();
     }
 
     void ComponentTest(){
@@ -250,10 +321,50 @@ public:
     }
 
 private:
+    struct ThreadState {
+        G_Xoshiro256 engine;
+        uint64_t epoch = 0;
+        uint64_t ordinal = nextOrdinal.fetch_add(1, std::memory_order_relaxed);
+    };
+    inline static std::atomic<uint64_t> baseSeed{0};
+    // Bumped on every reseed; a thread whose copy is stale reseeds itself.
+    inline static std::atomic<uint64_t> epoch{0};
+    inline static std::atomic<uint64_t> nextOrdinal{0};
+
+    static G_Xoshiro256& engine(){
+        thread_local ThreadState local;
+        uint64_t current = epoch.load(std::memory_order_acquire);
+        if (local.epoch != current) {
+            // Mixing the ordinal into the seed costs the same for every
+            // thread, however many came before it.
+            uint64_t ordinal = local.ordinal;
+            local.engine.seed(baseSeed.load(std::memory_order_relaxed) ^ G_Xoshiro256::splitmix64(ordinal));
+            local.epoch = current;
+        }
+        return local.engine;
+    }
+
+    // Lemire's method: a uniform value below range from the top of a 32x32 bit
+    // product, redrawing only when the low half lands in the short biased
+    // stretch. The division that finds that stretch runs only on the rare
+    // draws that might be in it.
+    static uint64_t bounded(G_Xoshiro256& source, uint64_t range){
+        uint64_t product = (source() >> 32) * range;
+        if (uint32_t(product) < range) {
+            uint32_t threshold = uint32_t((uint64_t(1) << 32) % range);
+            while (uint32_t(product) < threshold) product = (source() >> 32) * range;
+        }
+        return product >> 32;
+    }
+    // 24 random bits scaled into [0, 1); every result is an exact float.
+    static float unit_float(uint32_t bits){
+        return float(int32_t(bits >> 8)) * (1.0f / 16777216.0f);
+    }
+
     // Private constructor to prevent instantiation
     RandNo() {
         Logger l = Logger("RandNo Constructor");
-        std::srand(static_cast<unsigned int>(std::time(0))); // Seed the random number generator
+        reseed(static_cast<uint64_t>(std::time(0))); // Seed the random number generator
     }
 };
 
@@ -340,13 +451,8 @@ int main(){
             int desiredID = 00000;
             std::cout << "Enter ID of item you wish to edit: ";
             std::cin >> desiredID;
-            int index = -1;
-            for (int i = 0; i < database.length(); i++){
-                if (database[i].get_ID() == desiredID){
-                    std::cout << "Requested item found.";
-                    index = i;
-                }
-            }
+            int index = database.find_if([desiredID](Item& item){ return item.get_ID() == desiredID; });
+            if (index != -1) std::cout << "Requested item found.";
             if (index == -1){ std::cout << "Requested ID not found in database.\n"; }
             else {
                 std::cout << "Enter the new values for the item you are editing:\n";
@@ -13,7 +13,39 @@
 #include <iostream>
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <iomanip>
+#include <sstream>
+#include <ctime>
+#include <cstdlib>
+#include <type_traits>
+#include <new>
+#include <utility>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <initializer_list>
+#include <random>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define G_SIMD_X86 1
+#endif
 class Logger
 {
 private:
@@ -48,180 +80,3165 @@ public:
 };
 int Logger::depth = 0; // Init depth
 
+/*
+    G_Simd is a static class holding the vectorized search kernels used by
+    G_Array's find and count. Kernels exist for SSE2 (always present on x86-64)
+    and AVX2, and the widest one the running CPU supports is picked once via
+    cpuid. Anything else, including non-x86 builds, uses the scalar loop.
+*/
+class G_Simd {
+public:
+    // True if T has a vector kernel: arithmetic types of 1, 2, 4 or 8 bytes.
+    template <typename T>
+    static constexpr bool supports(){
+        return std::is_arithmetic<T>::value &&
+            (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+    }
+
+    // Returns true if the running CPU can execute the AVX2 kernels.
+    static bool has_avx2(){
+#ifdef G_SIMD_X86
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+#else
+        return false;
+#endif
+    }
+
+    // Index of the first element equal to value, or n if there is none.
+    template <typename T>
+    static size_t find(const T* data, size_t n, const T& value){
+#ifdef G_SIMD_X86
+        if constexpr (supports<T>()) {
+            if (has_avx2()) return avx2_find(data, n, value);
+            return sse2_find(data, n, value);
+        }
+#endif
+        return scalar_find(data, n, value);
+    }
+
+    // Number of elements equal to value.
+    template <typename T>
+    static size_t count(const T* data, size_t n, const T& value){
+#ifdef G_SIMD_X86
+        if constexpr (supports<T>()) {
+            if (has_avx2()) return avx2_count(data, n, value);
+            return sse2_count(data, n, value);
+        }
+#endif
+        return scalar_count(data, n, value);
+    }
+
+    // Times the dispatched kernels against the scalar loop on a few element
+    // types and prints the speedup of each.
+    static void Benchmark(size_t n = 1 << 22, int repeats = 20){
+        std::cout << "Beginning G_Simd benchmark (" << n << " elements, "
+                  << (has_avx2() ? "AVX2" : "SSE2/scalar") << ").\n";
+        benchmark_type<char>("char", n, repeats);
+        benchmark_type<short>("short", n, repeats);
+        benchmark_type<int>("int", n, repeats);
+        benchmark_type<long long>("long long", n, repeats);
+        benchmark_type<float>("float", n, repeats);
+        benchmark_type<double>("double", n, repeats);
+        std::cout << "Completed G_Simd benchmark.\n\n";
+    }
+
+    // The plain loops, kept public so the benchmark can compare against them.
+    template <typename T>
+    static size_t scalar_find(const T* data, size_t n, const T& value){
+        for (size_t i = 0; i < n; i++){
+            if (data[i] == value) return i;
+        }
+        return n;
+    }
+    template <typename T>
+    static size_t scalar_count(const T* data, size_t n, const T& value){
+        size_t total = 0;
+        for (size_t i = 0; i < n; i++){
+            if (data[i] == value) total++;
+        }
+        return total;
+    }
+
+private:
+    // Fills a buffer with zeros except for a needle in the last slot, so both
+    // find and count have to scan all n elements.
+    template <typename T>
+    static void benchmark_type(const char* name, size_t n, int repeats){
+        T* data = new T[n];
+        for (size_t i = 0; i < n; i++) data[i] = T(0);
+        data[n - 1] = T(1);
+        size_t sink = 0;
+        auto time = [&](auto fn){
+            auto begin = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeats; r++) sink += fn();
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - begin).count() / (double(n) * repeats);
+        };
+        double scalarFind = time([&]{ return scalar_find(data, n, T(1)); });
+        double fastFind = time([&]{ return find(data, n, T(1)); });
+        double scalarCount = time([&]{ return scalar_count(data, n, T(1)); });
+        double fastCount = time([&]{ return count(data, n, T(1)); });
+        std::cout << std::setw(10) << name << std::fixed << std::setprecision(3)
+                  << "  find: " << scalarFind << " -> " << fastFind << " ns/elem (x" << scalarFind / fastFind << ")"
+                  << "  count: " << scalarCount << " -> " << fastCount << " ns/elem (x" << scalarCount / fastCount << ")"
+                  << (sink == 0 ? "!" : "") << '\n';
+        std::cout.unsetf(std::ios::fixed);
+        delete[] data;
+    }
+
+#ifdef G_SIMD_X86
+    // movemask on 16-bit lanes yields two bits per match, every other width one.
+    template <typename T>
+    static constexpr int bits_per_lane(){ return sizeof(T) == 2 ? 2 : 1; }
+
+    // Bitmask of the 16 bytes at p that compare equal to value.
+    template <typename T>
+    static int sse2_mask(const T* p, T value){
+        if constexpr (std::is_same<T, float>::value) {
+            return _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(value)));
+        }
+        else if constexpr (std::is_same<T, double>::value) {
+            return _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(value)));
+        }
+        else {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if constexpr (sizeof(T) == 1) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(static_cast<char>(value))));
+            }
+            else if constexpr (sizeof(T) == 2) {
+                return _mm_movemask_epi8(_mm_cmpeq_epi16(block, _mm_set1_epi16(static_cast<short>(value))));
+            }
+            else if constexpr (sizeof(T) == 4) {
+                __m128i eq = _mm_cmpeq_epi32(block, _mm_set1_epi32(static_cast<int>(value)));
+                return _mm_movemask_ps(_mm_castsi128_ps(eq));
+            }
+            else {
+                // SSE2 has no 64-bit compare: both 32-bit halves must match.
+                __m128i eq = _mm_cmpeq_epi32(block, _mm_set1_epi64x(static_cast<long long>(value)));
+                eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+                return _mm_movemask_pd(_mm_castsi128_pd(eq));
+            }
+        }
+    }
+
+    // Bitmask of the 32 bytes at p that compare equal to value.
+    template <typename T>
+    __attribute__((target("avx2")))
+    static int avx2_mask(const T* p, T value){
+        if constexpr (std::is_same<T, float>::value) {
+            return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(value), _CMP_EQ_OQ));
+        }
+        else if constexpr (std::is_same<T, double>::value) {
+            return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(value), _CMP_EQ_OQ));
+        }
+        else {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            if constexpr (sizeof(T) == 1) {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(static_cast<char>(value))));
+            }
+            else if constexpr (sizeof(T) == 2) {
+                return _mm256_movemask_epi8(_mm256_cmpeq_epi16(block, _mm256_set1_epi16(static_cast<short>(value))));
+            }
+            else if constexpr (sizeof(T) == 4) {
+                __m256i eq = _mm256_cmpeq_epi32(block, _mm256_set1_epi32(static_cast<int>(value)));
+                return _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+            }
+            else {
+                __m256i eq = _mm256_cmpeq_epi64(block, _mm256_set1_epi64x(static_cast<long long>(value)));
+                return _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+            }
+        }
+    }
+
+    template <typename T>
+    static size_t sse2_find(const T* data, size_t n, T value){
+        const size_t lanes = 16 / sizeof(T);
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes){
+            unsigned mask = static_cast<unsigned>(sse2_mask(data + i, value));
+            if (mask) return i + __builtin_ctz(mask) / bits_per_lane<T>();
+        }
+        for (; i < n; i++){
+            if (data[i] == value) return i;
+        }
+        return n;
+    }
+    template <typename T>
+    static size_t sse2_count(const T* data, size_t n, T value){
+        const size_t lanes = 16 / sizeof(T);
+        size_t hits = 0, i = 0;
+        for (; i + lanes <= n; i += lanes){
+            hits += __builtin_popcount(static_cast<unsigned>(sse2_mask(data + i, value)));
+        }
+        hits /= bits_per_lane<T>();
+        for (; i < n; i++){
+            if (data[i] == value) hits++;
+        }
+        return hits;
+    }
+
+    template <typename T>
+    __attribute__((target("avx2")))
+    static size_t avx2_find(const T* data, size_t n, T value){
+        const size_t lanes = 32 / sizeof(T);
+        size_t i = 0;
+        for (; i + lanes <= n; i += lanes){
+            unsigned mask = static_cast<unsigned>(avx2_mask(data + i, value));
+            if (mask) return i + __builtin_ctz(mask) / bits_per_lane<T>();
+        }
+        for (; i < n; i++){
+            if (data[i] == value) return i;
+        }
+        return n;
+    }
+    template <typename T>
+    __attribute__((target("avx2")))
+    static size_t avx2_count(const T* data, size_t n, T value){
+        const size_t lanes = 32 / sizeof(T);
+        size_t hits = 0, i = 0;
+        for (; i + lanes <= n; i += lanes){
+            hits += __builtin_popcount(static_cast<unsigned>(avx2_mask(data + i, value)));
+        }
+        hits /= bits_per_lane<T>();
+        for (; i < n; i++){
+            if (data[i] == value) hits++;
+        }
+        return hits;
+    }
+#endif
+};
+
+/*
+    Allocation policies for G_Array and the containers built on it. A policy is
+    a class with static allocate(bytes) and deallocate(pointer, bytes) methods;
+    G_Array takes it as its second template parameter.
+
+    G_HeapAllocator is the default and just uses operator new.
+    G_HugePageAllocator maps blocks at or above its threshold with mmap, aligned
+    to 2 MB and flagged with madvise(MADV_HUGEPAGE) so the kernel can back them
+    with transparent huge pages. Smaller blocks go to the heap. Whether the
+    kernel actually granted huge pages is reported to hook() when a mapping is
+    released, or can be asked for at any time with huge_page_bytes().
+    Every block starts with a small Prefix recording how it was allocated, so
+    deallocate never has to guess, even if threshold() changed in between.
+*/
+class G_HeapAllocator {
+public:
+    static void* allocate(size_t bytes){
+        return ::operator new(bytes);
+    }
+    static void deallocate(void* block, size_t){
+        ::operator delete(block);
+    }
+};
+
+class G_HugePageAllocator {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    // Passed to the instrumentation hook for every block at or above threshold.
+    struct Event {
+        bool released;        // false when the block was just mapped
+        void* block;
+        size_t bytes;         // bytes requested by the container
+        size_t mappedBytes;   // bytes actually mapped (rounded to 2 MB)
+        bool mapped;          // false if mmap failed and the heap was used
+        bool hugePagesAdvised; // madvise(MADV_HUGEPAGE) succeeded
+        size_t hugePageBytes; // on release, how much was backed by huge pages
+    };
+    typedef void (*Hook)(const Event&);
+
+    // Blocks of at least this many bytes are mapped with huge pages.
+    static size_t& threshold(){
+        static size_t bytes = size_t(4) << 20;
+        return bytes;
+    }
+    // Set to receive an Event for every mapping and unmapping.
+    static Hook& hook(){
+        static Hook h = nullptr;
+        return h;
+    }
+
+    static void* allocate(size_t bytes){
+        if (bytes < threshold()) return heap_block(bytes, false);
+        Event e = {false, nullptr, bytes, round_up(bytes + PREFIX_BYTES), false, false, 0};
+#ifdef __linux__
+        // Over-map by one huge page, then trim so the block starts on a 2 MB boundary.
+        size_t span = e.mappedBytes + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+            uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1);
+            if (aligned > start) munmap(raw, aligned - start);
+            uintptr_t tail = aligned + e.mappedBytes;
+            if (start + span > tail) munmap(reinterpret_cast<void*>(tail), start + span - tail);
+            e.mapped = true;
+            e.hugePagesAdvised = madvise(reinterpret_cast<void*>(aligned), e.mappedBytes, MADV_HUGEPAGE) == 0;
+            e.block = stamp(reinterpret_cast<void*>(aligned), e.mappedBytes, true);
+        }
+#endif
+        if (!e.mapped) e.block = heap_block(bytes, true);
+        if (hook()) hook()(e);
+        return e.block;
+    }
+
+    static void deallocate(void* block, size_t bytes){
+        Prefix* prefix = reinterpret_cast<Prefix*>(static_cast<char*>(block) - PREFIX_BYTES);
+        if (!prefix->mappedBytes) {
+            bool reported = prefix->reported;
+            G_HeapAllocator::deallocate(prefix, bytes + PREFIX_BYTES);
+            if (reported && hook()) hook()(Event{true, block, bytes, round_up(bytes + PREFIX_BYTES), false, false, 0});
+            return;
+        }
+        Event e = {true, block, bytes, prefix->mappedBytes, true, false, 0};
+#ifdef __linux__
+        // The block has been used by now, so this is where the hook can be
+        // told how much of it the kernel really gave huge pages.
+        if (hook()) e.hugePageBytes = huge_page_bytes(block);
+        munmap(prefix, e.mappedBytes);
+#endif
+        if (hook()) hook()(e);
+    }
+
+    // How many bytes of the mapping containing block the kernel has actually
+    // backed with huge pages, read from /proc/self/smaps. Pages are only
+    // granted once touched, so call this after filling the container.
+    static size_t huge_page_bytes(const void* block){
+        size_t granted = 0;
+#ifdef __linux__
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        uintptr_t target = reinterpret_cast<uintptr_t>(block);
+        bool inRegion = false;
+        while (std::getline(smaps, line)) {
+            unsigned long long low, high;
+            if (std::sscanf(line.c_str(), "%llx-%llx", &low, &high) == 2) {
+                inRegion = target >= low && target < high;
+            }
+            else if (inRegion && line.compare(0, 14, "AnonHugePages:") == 0) {
+                granted = std::stoull(line.substr(14)) * 1024;
+                break;
+            }
+        }
+#endif
+        return granted;
+    }
+
+private:
+    // Sits just before each block. mappedBytes is the length of the mapping
+    // that starts at the prefix, or 0 for a heap block; reported is set for
+    // blocks the hook was told about. A cache line is reserved for it, which
+    // keeps the block after it as aligned as the heap or mapping gave.
+    struct Prefix {
+        size_t mappedBytes;
+        bool reported;
+    };
+    static constexpr size_t PREFIX_BYTES = 64;
+
+    static void* stamp(void* start, size_t mappedBytes, bool reported){
+        Prefix* prefix = new (start) Prefix{mappedBytes, reported};
+        return reinterpret_cast<char*>(prefix) + PREFIX_BYTES;
+    }
+    static void* heap_block(size_t bytes, bool reported){
+        return stamp(G_HeapAllocator::allocate(bytes + PREFIX_BYTES), 0, reported);
+    }
+    static size_t round_up(size_t bytes){
+        return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+};
+
+/*
+    G_CheapCompare marks comparators that are cheap enough, and branch-
+    unpredictable enough, that G_Sort should partition with the branchless
+    block method. The stock functors opt in for arithmetic types below their
+    definitions.
+*/
+template <typename Compare>
+struct G_CheapCompare : std::false_type {};
+
+/*
+    G_RadixOrder says whether a comparator is just an ordering on arithmetic
+    values, in which case G_Array::sort can radix sort instead. value_type is
+    the type compared, descending is the direction of the resulting order, and
+    byMagnitude means the values are compared by absolute value. Comparators
+    opt in below their definitions.
+*/
+template <typename Compare>
+struct G_RadixOrder {
+    typedef void value_type;
+    static const bool supported = false;
+    static const bool descending = false;
+    static const bool byMagnitude = false;
+};
+
+/*
+    G_Sort is a static class of sorting routines that work on a raw [first, last)
+    range with a comparator functor, where comp(a, b) is true if a belongs before
+    b. G_Array and the other containers sort through it.
+
+    introsort is a pattern-defeating quicksort: ninther pivots, insertion sort
+    for small partitions, a heapsort fallback after too many unbalanced
+    partitions, and branchless block partitioning for cheap comparators.
+    O(n log n) worst case, and close to O(n) on already sorted input.
+
+    radix_sort is a stable LSD radix sort with 8-bit digits for arithmetic
+    values. Keys are mapped to unsigned integers that order the same way
+    (sign bit flipped for signed types, all bits flipped for negative floats),
+    and digit positions where every key agrees are skipped.
+
+    parallel_merge_sort splits the range into one chunk per thread, introsorts
+    the chunks concurrently, then merges them pairwise. Every merge is cut
+    into per-thread pieces with a merge-path search, so all threads stay busy
+    through the last round. Chunk boundaries depend only on the length and the
+    thread count, so a given input always sorts the same way.
+
+    timsort is a stable adaptive merge sort. It finds the natural runs
+    (reversing strictly descending ones), extends short runs with binary
+    insertion sort, and merges with galloping, so nearly sorted or reversed
+    input costs close to O(n).
+
+    nth_element, partial_sort and top_k answer "which elements come first"
+    without a full sort: introselect for the first two, a size-k heap for
+    top_k.
+*/
+class G_Sort {
+public:
+    // Below this many elements introsort beats the radix passes.
+    static const size_t RADIX_THRESHOLD = 512;
+    // Below this many elements parallel_sort just sorts on one thread.
+    static const size_t PARALLEL_THRESHOLD = size_t(1) << 17;
+
+    // True for the types radix_sort accepts.
+    template <typename T>
+    static constexpr bool radix_sortable(){
+        return std::is_arithmetic<T>::value && sizeof(T) <= 8;
+    }
+
+    // The default sort: radix sort for large ranges of numbers compared with
+    // one of the stock functors, introsort for everything else. On the radix
+    // path, input that is already in order is spotted with one linear pass
+    // and left alone.
+    template <typename T, typename Compare>
+    static void sort(T* first, T* last, Compare comp){
+        typedef G_RadixOrder<Compare> Radix;
+        if constexpr (Radix::supported && std::is_same<typename Radix::value_type, T>::value) {
+            if (static_cast<size_t>(last - first) >= RADIX_THRESHOLD) {
+                // Radix sort can't take advantage of sorted input, so check
+                // for it first. Unsorted input fails this almost immediately.
+                T* cur = first + 1;
+                while (cur != last && !comp(*cur, *(cur - 1))) cur++;
+                if (cur == last) return;
+                if (Radix::byMagnitude) radix_sort_by_key(first, last, [](const T& v){ return magnitude(v); }, Radix::descending);
+                else radix_sort(first, last, Radix::descending);
+                return;
+            }
+        }
+        introsort(first, last, comp);
+    }
+
+    template <typename T, typename Compare>
+    static void introsort(T* first, T* last, Compare comp){
+        size_t n = last - first;
+        if (n < 2) return;
+        const bool branchless = std::is_arithmetic<T>::value && G_CheapCompare<Compare>::value;
+        introsort_loop<T, Compare, branchless>(first, last, comp, floor_log2(n), true);
+    }
+
+    template <typename T, typename Compare>
+    static void insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    template <typename T, typename Compare>
+    static void heap_sort(T* first, T* last, Compare comp){
+        make_heap(first, last - first, comp);
+        sort_heap(first, last - first, comp);
+    }
+
+    // Rearranges the range so *nth is the element a full sort would put
+    // there, with nothing after it ordered before it and nothing before it
+    // ordered after it. Introselect: quickselect with ninther pivots, falling
+    // back to a heap selection if the partitions keep coming out unbalanced.
+    // O(n) on average.
+    template <typename T, typename Compare>
+    static void nth_element(T* first, T* nth, T* last, Compare comp){
+        if (nth >= last || last - first < 2) return;
+        int badAllowed = floor_log2(last - first);
+        bool leftmost = true;
+        while (static_cast<size_t>(last - first) >= INSERTION_THRESHOLD){
+            size_t size = last - first;
+            size_t s2 = size / 2;
+            if (size > NINTHER_THRESHOLD) {
+                sort3(first, first + s2, last - 1, comp);
+                sort3(first + 1, first + (s2 - 1), last - 2, comp);
+                sort3(first + 2, first + (s2 + 1), last - 3, comp);
+                sort3(first + (s2 - 1), first + s2, first + (s2 + 1), comp);
+                std::swap(*first, *(first + s2));
+            }
+            else sort3(first + s2, first, last - 1, comp);
+
+            // The pivot equals the element before the range, so everything
+            // partitioned left of it is equal to it too.
+            if (!leftmost && !comp(*(first - 1), *first)) {
+                T* pivotPos = partition_left(first, last, comp);
+                if (nth <= pivotPos) return;
+                first = pivotPos + 1;
+                continue;
+            }
+            T* pivotPos = partition_right(first, last, comp).first;
+            size_t sizeL = pivotPos - first;
+            size_t sizeR = last - (pivotPos + 1);
+            if ((sizeL < size / 8 || sizeR < size / 8) && --badAllowed == 0) {
+                partial_heap_sort(first, nth + 1, last, comp);
+                return;
+            }
+            if (pivotPos == nth) return;
+            if (nth < pivotPos) last = pivotPos;
+            else {
+                first = pivotPos + 1;
+                leftmost = false;
+            }
+        }
+        insertion_sort(first, last, comp);
+    }
+
+    // Sorts the range far enough that [first, middle) holds the smallest
+    // elements in order. Selects with nth_element and then sorts just the
+    // prefix: O(n + k log k) for k = middle - first.
+    template <typename T, typename Compare>
+    static void partial_sort(T* first, T* middle, T* last, Compare comp){
+        if (middle <= first) return;
+        // With k = n there is nothing to select; sort it all.
+        if (middle >= last) {
+            introsort(first, last, comp);
+            return;
+        }
+        // nth_element leaves middle - 1 in its final place, so only the
+        // elements before it still need sorting.
+        nth_element(first, middle - 1, last, comp);
+        introsort(first, middle - 1, comp);
+    }
+
+    // Checks nth_element, partial_sort and top_k against a full sort on random
+    // arrays with many duplicates, for every k from 0 to n.
+    static bool SelectionTest(size_t rounds = 200, size_t maxSize = 64){
+        std::mt19937 rng(33);
+        auto less = [](const int& a, const int& b){ return a < b; };
+        bool ok = true;
+        int* input = new int[maxSize];
+        int* sorted = new int[maxSize];
+        int* work = new int[maxSize];
+        for (size_t round = 0; round < rounds && ok; round++){
+            size_t n = 1 + rng() % maxSize;
+            for (size_t i = 0; i < n; i++) input[i] = static_cast<int>(rng() % (n / 2 + 1));
+            std::copy(input, input + n, sorted);
+            introsort(sorted, sorted + n, less);
+            for (size_t k = 0; k <= n && ok; k++){
+                std::copy(input, input + n, work);
+                partial_sort(work, work + k, work + n, less);
+                ok = std::equal(work, work + k, sorted);
+                if (k < n) {
+                    std::copy(input, input + n, work);
+                    nth_element(work, work + k, work + n, less);
+                    ok = ok && work[k] == sorted[k];
+                }
+                if (k > 0) {
+                    top_k(input, input + n, work, k, less);
+                    ok = ok && std::equal(work, work + k, sorted);
+                }
+            }
+        }
+        delete[] work;
+        delete[] sorted;
+        delete[] input;
+        std::cout << "G_Sort selection test: " << rounds << " arrays, " << (ok ? "passed" : "FAILED") << ".\n";
+        return ok;
+    }
+
+    // Copies the k elements of [first, last) that would come first after a
+    // sort into out, in order, without touching the input. out must hold k
+    // constructed elements. One pass with a max-heap of size k: O(n log k).
+    template <typename T, typename Compare>
+    static void top_k(const T* first, const T* last, T* out, size_t k, Compare comp){
+        if (k == 0) return;
+        for (size_t i = 0; i < k; i++) out[i] = first[i];
+        make_heap(out, k, comp);
+        for (const T* cur = first + k; cur < last; cur++){
+            // The heap root is the worst of the best k seen so far.
+            if (comp(*cur, out[0])) {
+                out[0] = *cur;
+                sift_down(out, 0, k, comp);
+            }
+        }
+        sort_heap(out, k, comp);
+    }
+
+    // Binary search over a range where goesRight holds for a prefix and fails
+    // for the rest; returns the first element it fails for. Branchless: each
+    // step halves the range with a conditional move, so there is no jump for
+    // the CPU to mispredict.
+    template <typename T, typename Predicate>
+    static const T* partition_point(const T* first, const T* last, Predicate goesRight){
+        size_t n = last - first;
+        if (n == 0) return first;
+        while (n > 1){
+            size_t half = n / 2;
+            first = goesRight(first[half]) ? first + half : first;
+            n -= half;
+        }
+        return first + goesRight(*first);
+    }
+
+    // Sorts arithmetic values ascending, or descending if asked.
+    template <typename T>
+    static void radix_sort(T* first, T* last, bool descending = false){
+        static_assert(radix_sortable<T>(), "radix_sort needs arithmetic elements of at most 8 bytes");
+        typedef typename RadixKey<T>::type U;
+        size_t n = last - first;
+        if (n < 2) return;
+        U* keys = new U[n];
+        U* keyBuffer = new U[n];
+        for (size_t i = 0; i < n; i++) keys[i] = radix_encode(first[i], descending);
+        radix_passes<U, T, false>(keys, keyBuffer, nullptr, nullptr, n);
+        for (size_t i = 0; i < n; i++) first[i] = radix_decode<T>(keys[i], descending);
+        delete[] keyBuffer;
+        delete[] keys;
+    }
+
+    // Sorts any elements by an arithmetic key, computed once per element by
+    // proj. Equal keys keep their original order.
+    template <typename T, typename Projection>
+    static void radix_sort_by_key(T* first, T* last, Projection proj, bool descending = false){
+        typedef typename std::decay<decltype(proj(*first))>::type K;
+        static_assert(radix_sortable<K>(), "radix_sort_by_key needs an arithmetic key of at most 8 bytes");
+        typedef typename RadixKey<K>::type U;
+        size_t n = last - first;
+        if (n < 2) return;
+        U* keys = new U[n];
+        U* keyBuffer = new U[n];
+        T* valueBuffer = new T[n];
+        for (size_t i = 0; i < n; i++) keys[i] = radix_encode(proj(first[i]), descending);
+        radix_passes<U, T, true>(keys, keyBuffer, first, valueBuffer, n);
+        delete[] valueBuffer;
+        delete[] keyBuffer;
+        delete[] keys;
+    }
+
+    // Sorts with up to threads threads (0 means one per core). Ranges too
+    // small to benefit are introsorted on the calling thread.
+    template <typename T, typename Compare>
+    static void parallel_merge_sort(T* first, T* last, Compare comp, unsigned threads = 0){
+        size_t n = last - first;
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads > n / PARALLEL_CHUNK_MIN) threads = static_cast<unsigned>(n / PARALLEL_CHUNK_MIN);
+        if (threads < 2) {
+            introsort(first, last, comp);
+            return;
+        }
+
+        // Run boundaries: run r is [bounds[r], bounds[r + 1]).
+        size_t runs = threads;
+        size_t* bounds = new size_t[runs + 1];
+        for (size_t r = 0; r <= runs; r++) bounds[r] = n * r / runs;
+        run_parallel(threads, [&](size_t t){
+            introsort(first + bounds[t], first + bounds[t + 1], comp);
+        });
+
+        T* buffer = new T[n];
+        size_t* splits = new size_t[threads + 1];
+        T* src = first;
+        T* dst = buffer;
+        while (runs > 1){
+            // Every pair of runs becomes one; each merge is split into pieces
+            // of about n / threads outputs, one piece per task. The split
+            // points are all found before any merging starts, because merging
+            // moves elements out of src that the searches would compare.
+            size_t pieces = threads;
+            size_t merged = (runs + 1) / 2;
+            run_parallel(pieces, [&](size_t t){
+                size_t k = n * t / pieces;
+                size_t r = 0;
+                while (r + 2 < runs && bounds[r + 2] <= k) r += 2;
+                size_t lo = bounds[r];
+                size_t mid = bounds[r + 1];
+                size_t hi = r + 2 <= runs ? bounds[r + 2] : mid;
+                splits[t] = merge_path(src + lo, mid - lo, src + mid, hi - mid, k - lo, comp);
+            });
+            run_parallel(pieces, [&](size_t t){
+                size_t outBegin = n * t / pieces;
+                size_t outEnd = n * (t + 1) / pieces;
+                for (size_t r = 0; r < runs; r += 2){
+                    size_t lo = bounds[r];
+                    size_t mid = bounds[r + 1];
+                    size_t hi = r + 2 <= runs ? bounds[r + 2] : mid;
+                    size_t begin = lo > outBegin ? lo : outBegin;
+                    size_t end = hi < outEnd ? hi : outEnd;
+                    if (begin >= end) continue;
+                    // Where this piece starts and ends within each input run.
+                    size_t i0 = begin == lo ? 0 : splits[t];
+                    size_t i1 = end == hi ? mid - lo : splits[t + 1];
+                    merge_move(src + lo + i0, src + lo + i1,
+                               src + mid + (begin - lo - i0), src + mid + (end - lo - i1),
+                               dst + begin, comp);
+                }
+            });
+            for (size_t r = 0; r < merged; r++) bounds[r] = bounds[2 * r];
+            bounds[merged] = n;
+            runs = merged;
+            std::swap(src, dst);
+        }
+        if (src != first) {
+            run_parallel(threads, [&](size_t t){
+                for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) first[i] = std::move(src[i]);
+            });
+        }
+        delete[] splits;
+        delete[] buffer;
+        delete[] bounds;
+    }
+
+    // Stable sort. Equal elements keep their order, and input that is already
+    // made of long sorted or reversed runs sorts in close to O(n).
+    template <typename T, typename Compare>
+    static void timsort(T* first, T* last, Compare comp){
+        if (last - first < 2) return;
+        TimSort<T, Compare> sorter(first, comp);
+        sorter.sort(last - first);
+    }
+
+    // Sorts by a key that proj computes once per element; comp compares keys.
+    // Elements are decorated with their key and position, the decorated
+    // array is sorted, and the elements are moved into the resulting order.
+    // Ties keep their original order.
+    template <typename T, typename Projection, typename Compare>
+    static void sort_by_key(T* first, T* last, Projection proj, Compare comp){
+        typedef typename std::decay<decltype(proj(*first))>::type K;
+        size_t n = last - first;
+        if (n < 2) return;
+        typedef G_RadixOrder<Compare> Radix;
+        if constexpr (Radix::supported && std::is_same<typename Radix::value_type, K>::value) {
+            if (n >= RADIX_THRESHOLD && !Radix::byMagnitude) {
+                radix_sort_by_key(first, last, proj, Radix::descending);
+                return;
+            }
+        }
+        Decorated<K>* decorated = new Decorated<K>[n];
+        for (size_t i = 0; i < n; i++){
+            decorated[i].key = proj(first[i]);
+            decorated[i].index = i;
+        }
+        introsort(decorated, decorated + n, [&comp](const Decorated<K>& a, const Decorated<K>& b){
+            if (comp(a.key, b.key)) return true;
+            if (comp(b.key, a.key)) return false;
+            return a.index < b.index;
+        });
+        T* sorted = new T[n];
+        for (size_t i = 0; i < n; i++) sorted[i] = std::move(first[decorated[i].index]);
+        for (size_t i = 0; i < n; i++) first[i] = std::move(sorted[i]);
+        delete[] sorted;
+        delete[] decorated;
+    }
+
+    // Times sorting strings and records with by-value comparators, the
+    // const reference functors, and sort_by_key, and prints the results.
+    // Each group of three sorts on the same key (string length, record value)
+    // so the rows compare like with like.
+    static void BenchmarkSortByKey(size_t n = 200000){
+        std::cout << "Beginning sort_by_key benchmark (" << n << " elements).\n";
+        std::mt19937 rng(400);
+        struct Record {
+            std::string name;
+            int quantity;
+            double price;
+        };
+        // A comparator written the way the functors used to be: by value,
+        // recomputing the key on every call.
+        struct ByValueLength {
+            bool operator()(std::string a, std::string b) const { return a.size() < b.size(); }
+        };
+        struct ByValueValue {
+            bool operator()(Record a, Record b) const { return a.quantity * a.price < b.quantity * b.price; }
+        };
+        struct ByRefLength {
+            bool operator()(const std::string& a, const std::string& b) const { return a.size() < b.size(); }
+        };
+        struct ByRefValue {
+            bool operator()(const Record& a, const Record& b) const { return a.quantity * a.price < b.quantity * b.price; }
+        };
+        struct LessDouble {
+            bool operator()(const double& a, const double& b) const { return a < b; }
+        };
+
+        std::string* names = new std::string[n];
+        Record* records = new Record[n];
+        for (size_t i = 0; i < n; i++){
+            names[i] = "creature_" + std::to_string(rng()) + std::string(rng() % 24, 'x');
+            records[i].name = names[i];
+            records[i].quantity = static_cast<int>(rng() % 1000);
+            records[i].price = (rng() % 100000) / 100.0;
+        }
+        std::string* stringWork = new std::string[n];
+        Record* recordWork = new Record[n];
+        auto time = [&](const char* label, auto reset, auto run){
+            reset();
+            auto begin = std::chrono::steady_clock::now();
+            run();
+            auto end = std::chrono::steady_clock::now();
+            std::cout << std::setw(40) << label << ": " << std::fixed << std::setprecision(1)
+                      << std::chrono::duration<double, std::nano>(end - begin).count() / n << " ns/elem\n";
+            std::cout.unsetf(std::ios::fixed);
+        };
+        auto resetStrings = [&]{ for (size_t i = 0; i < n; i++) stringWork[i] = names[i]; };
+        auto resetRecords = [&]{ for (size_t i = 0; i < n; i++) recordWork[i] = records[i]; };
+
+        time("strings by length, by-value comparator", resetStrings, [&]{ introsort(stringWork, stringWork + n, ByValueLength()); });
+        time("strings by length, const& comparator", resetStrings, [&]{ introsort(stringWork, stringWork + n, ByRefLength()); });
+        time("strings by length, sort_by_key", resetStrings, [&]{
+            sort_by_key(stringWork, stringWork + n, [](const std::string& s){ return s.size(); },
+                        [](const size_t& a, const size_t& b){ return a < b; });
+        });
+        time("records by value, by-value comparator", resetRecords, [&]{ introsort(recordWork, recordWork + n, ByValueValue()); });
+        time("records by value, const& comparator", resetRecords, [&]{ introsort(recordWork, recordWork + n, ByRefValue()); });
+        time("records by value, sort_by_key", resetRecords, [&]{
+            sort_by_key(recordWork, recordWork + n, [](const Record& r){ return r.quantity * r.price; }, LessDouble());
+        });
+
+        delete[] recordWork;
+        delete[] stringWork;
+        delete[] records;
+        delete[] names;
+        std::cout << "Completed sort_by_key benchmark.\n\n";
+    }
+
+    // The absolute value of v in a type that can hold it, for sorting by
+    // magnitude. Signed integers map to their unsigned type so the most
+    // negative value doesn't overflow.
+    template <typename T>
+    static auto magnitude(T v){
+        if constexpr (std::is_floating_point<T>::value) return std::abs(v);
+        else if constexpr (std::is_signed<T>::value) {
+            typedef typename std::make_unsigned<T>::type U;
+            return v < 0 ? U(U(0) - U(v)) : U(v);
+        }
+        else return v;
+    }
+
+private:
+    template <typename T>
+    struct RadixKey {
+        typedef typename std::conditional<sizeof(T) == 1, uint8_t,
+                typename std::conditional<sizeof(T) == 2, uint16_t,
+                typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type>::type>::type type;
+    };
+
+    // Maps a value to an unsigned key with the same ordering.
+    template <typename T>
+    static typename RadixKey<T>::type radix_encode(T value, bool descending){
+        typedef typename RadixKey<T>::type U;
+        const U sign = U(U(1) << (sizeof(U) * 8 - 1));
+        U bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        if constexpr (std::is_floating_point<T>::value) bits = (bits & sign) ? U(~bits) : U(bits | sign);
+        else if constexpr (std::is_signed<T>::value) bits = U(bits ^ sign);
+        return descending ? U(~bits) : bits;
+    }
+    template <typename T>
+    static T radix_decode(typename RadixKey<T>::type bits, bool descending){
+        typedef typename RadixKey<T>::type U;
+        const U sign = U(U(1) << (sizeof(U) * 8 - 1));
+        if (descending) bits = U(~bits);
+        if constexpr (std::is_floating_point<T>::value) bits = (bits & sign) ? U(bits ^ sign) : U(~bits);
+        else if constexpr (std::is_signed<T>::value) bits = U(bits ^ sign);
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    template <typename K>
+    struct Decorated {
+        K key;
+        size_t index;
+    };
+
+    // Runs the LSD passes over keys, moving values along with them if Carry.
+    // Results end up back in keys and values.
+    template <typename U, typename V, bool Carry>
+    static void radix_passes(U* keys, U* keyBuffer, V* values, V* valueBuffer, size_t n){
+        size_t counts[sizeof(U)][256] = {};
+        for (size_t i = 0; i < n; i++){
+            U key = keys[i];
+            for (size_t p = 0; p < sizeof(U); p++) counts[p][(key >> (8 * p)) & 0xFF]++;
+        }
+        U* src = keys;
+        U* dst = keyBuffer;
+        V* valueSrc = values;
+        V* valueDst = valueBuffer;
+        for (size_t p = 0; p < sizeof(U); p++){
+            const unsigned shift = 8 * p;
+            if (counts[p][(src[0] >> shift) & 0xFF] == n) continue; // every key shares this digit
+            size_t offsets[256];
+            size_t total = 0;
+            for (size_t d = 0; d < 256; d++){
+                offsets[d] = total;
+                total += counts[p][d];
+            }
+            for (size_t i = 0; i < n; i++){
+                size_t pos = offsets[(src[i] >> shift) & 0xFF]++;
+                dst[pos] = src[i];
+                if constexpr (Carry) valueDst[pos] = std::move(valueSrc[i]);
+            }
+            std::swap(src, dst);
+            if constexpr (Carry) std::swap(valueSrc, valueDst);
+        }
+        if (src != keys) {
+            for (size_t i = 0; i < n; i++){
+                keys[i] = src[i];
+                if constexpr (Carry) values[i] = std::move(valueSrc[i]);
+            }
+        }
+    }
+
+    // TimSort's state for one call: the pending run stack, the merge buffer
+    // and the adaptive galloping threshold. Indexes are signed because merge_hi
+    // walks its cursors one past the start of the range.
+    template <typename T, typename Compare>
+    class TimSort {
+    public:
+        TimSort(T* a, Compare comp) : a(a), comp(comp), minGallop(MIN_GALLOP),
+                                      buffer(nullptr), bufferSize(0), stackSize(0) {}
+        ~TimSort(){ delete[] buffer; }
+
+        void sort(ptrdiff_t n){
+            ptrdiff_t minRun = min_run_length(n);
+            ptrdiff_t lo = 0;
+            while (lo < n){
+                ptrdiff_t runLength = count_run_and_make_ascending(lo, n);
+                // Extend short runs to minRun with binary insertion sort.
+                if (runLength < minRun) {
+                    ptrdiff_t forced = n - lo < minRun ? n - lo : minRun;
+                    binary_insertion_sort(lo, lo + forced, lo + runLength);
+                    runLength = forced;
+                }
+                runBase[stackSize] = lo;
+                runLength_[stackSize] = runLength;
+                stackSize++;
+                merge_collapse();
+                lo += runLength;
+            }
+            while (stackSize > 1){
+                ptrdiff_t i = stackSize - 2;
+                if (i > 0 && runLength_[i - 1] < runLength_[i + 1]) i--;
+                merge_at(i);
+            }
+        }
+
+    private:
+        static const ptrdiff_t MIN_MERGE = 32;
+        static const ptrdiff_t MIN_GALLOP = 7;
+
+        T* a;
+        Compare comp;
+        ptrdiff_t minGallop;
+        T* buffer;
+        ptrdiff_t bufferSize;
+        // Runs waiting to be merged. 85 entries covers any 64-bit length
+        // given the stack invariants.
+        ptrdiff_t runBase[85];
+        ptrdiff_t runLength_[85];
+        ptrdiff_t stackSize;
+
+        // A run length between 16 and 32 such that n / minRun is a power of
+        // two or just under, which keeps the final merges balanced.
+        static ptrdiff_t min_run_length(ptrdiff_t n){
+            ptrdiff_t low = 0;
+            while (n >= MIN_MERGE){
+                low |= n & 1;
+                n >>= 1;
+            }
+            return n + low;
+        }
+
+        // Length of the run starting at lo. A strictly descending run is
+        // reversed in place; strictness keeps the sort stable.
+        ptrdiff_t count_run_and_make_ascending(ptrdiff_t lo, ptrdiff_t hi){
+            ptrdiff_t runHi = lo + 1;
+            if (runHi == hi) return 1;
+            if (comp(a[runHi++], a[lo])) {
+                while (runHi < hi && comp(a[runHi], a[runHi - 1])) runHi++;
+                for (ptrdiff_t i = lo, j = runHi - 1; i < j; i++, j--) std::swap(a[i], a[j]);
+            }
+            else {
+                while (runHi < hi && !comp(a[runHi], a[runHi - 1])) runHi++;
+            }
+            return runHi - lo;
+        }
+
+        // Sorts [lo, hi) given that [lo, start) is already sorted.
+        void binary_insertion_sort(ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t start){
+            for (; start < hi; start++){
+                T pivot = std::move(a[start]);
+                ptrdiff_t left = lo, right = start;
+                while (left < right){
+                    ptrdiff_t mid = left + (right - left) / 2;
+                    if (comp(pivot, a[mid])) right = mid;
+                    else left = mid + 1;
+                }
+                std::move_backward(a + left, a + start, a + start + 1);
+                a[left] = std::move(pivot);
+            }
+        }
+
+        // Merges adjacent runs until the stack lengths shrink faster than the
+        // Fibonacci numbers, which bounds the stack depth.
+        void merge_collapse(){
+            while (stackSize > 1){
+                ptrdiff_t i = stackSize - 2;
+                if ((i > 0 && runLength_[i - 1] <= runLength_[i] + runLength_[i + 1]) ||
+                    (i > 1 && runLength_[i - 2] <= runLength_[i - 1] + runLength_[i])) {
+                    if (runLength_[i - 1] < runLength_[i + 1]) i--;
+                }
+                else if (runLength_[i] > runLength_[i + 1]) break;
+                merge_at(i);
+            }
+        }
+
+        // Merges stack runs i and i + 1.
+        void merge_at(ptrdiff_t i){
+            ptrdiff_t base1 = runBase[i], length1 = runLength_[i];
+            ptrdiff_t base2 = runBase[i + 1], length2 = runLength_[i + 1];
+            runLength_[i] = length1 + length2;
+            if (i == stackSize - 3) {
+                runBase[i + 1] = runBase[i + 2];
+                runLength_[i + 1] = runLength_[i + 2];
+            }
+            stackSize--;
+
+            // Elements of run 1 already before all of run 2, and of run 2
+            // already after all of run 1, stay where they are.
+            ptrdiff_t k = gallop_right(a[base2], a, base1, length1, 0);
+            base1 += k;
+            length1 -= k;
+            if (length1 == 0) return;
+            length2 = gallop_left(a[base1 + length1 - 1], a, base2, length2, length2 - 1);
+            if (length2 == 0) return;
+
+            if (length1 <= length2) merge_lo(base1, length1, base2, length2);
+            else merge_hi(base1, length1, base2, length2);
+        }
+
+        // Leftmost position in range[base, base + length) where key could be
+        // inserted, searched outward from hint in doubling steps.
+        ptrdiff_t gallop_left(const T& key, const T* range, ptrdiff_t base, ptrdiff_t length, ptrdiff_t hint){
+            ptrdiff_t lastOffset = 0, offset = 1;
+            if (comp(range[base + hint], key)) {
+                ptrdiff_t maxOffset = length - hint;
+                while (offset < maxOffset && comp(range[base + hint + offset], key)){
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                if (offset > maxOffset) offset = maxOffset;
+                lastOffset += hint;
+                offset += hint;
+            }
+            else {
+                ptrdiff_t maxOffset = hint + 1;
+                while (offset < maxOffset && !comp(range[base + hint - offset], key)){
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                if (offset > maxOffset) offset = maxOffset;
+                ptrdiff_t tmp = lastOffset;
+                lastOffset = hint - offset;
+                offset = hint - tmp;
+            }
+            lastOffset++;
+            while (lastOffset < offset){
+                ptrdiff_t mid = lastOffset + (offset - lastOffset) / 2;
+                if (comp(range[base + mid], key)) lastOffset = mid + 1;
+                else offset = mid;
+            }
+            return offset;
+        }
+
+        // Like gallop_left, but the rightmost insertion position.
+        ptrdiff_t gallop_right(const T& key, const T* range, ptrdiff_t base, ptrdiff_t length, ptrdiff_t hint){
+            ptrdiff_t lastOffset = 0, offset = 1;
+            if (comp(key, range[base + hint])) {
+                ptrdiff_t maxOffset = hint + 1;
+                while (offset < maxOffset && comp(key, range[base + hint - offset])){
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                if (offset > maxOffset) offset = maxOffset;
+                ptrdiff_t tmp = lastOffset;
+                lastOffset = hint - offset;
+                offset = hint - tmp;
+            }
+            else {
+                ptrdiff_t maxOffset = length - hint;
+                while (offset < maxOffset && !comp(key, range[base + hint + offset])){
+                    lastOffset = offset;
+                    offset = offset * 2 + 1;
+                }
+                if (offset > maxOffset) offset = maxOffset;
+                lastOffset += hint;
+                offset += hint;
+            }
+            lastOffset++;
+            while (lastOffset < offset){
+                ptrdiff_t mid = lastOffset + (offset - lastOffset) / 2;
+                if (comp(key, range[base + mid])) offset = mid;
+                else lastOffset = mid + 1;
+            }
+            return offset;
+        }
+
+        T* ensure_buffer(ptrdiff_t length){
+            if (bufferSize < length) {
+                delete[] buffer;
+                buffer = new T[length];
+                bufferSize = length;
+            }
+            return buffer;
+        }
+
+        // Merges two runs when the first is the shorter, left to right with
+        // the first run moved out to the buffer.
+        void merge_lo(ptrdiff_t base1, ptrdiff_t length1, ptrdiff_t base2, ptrdiff_t length2){
+            T* tmp = ensure_buffer(length1);
+            std::move(a + base1, a + base1 + length1, tmp);
+            ptrdiff_t cursor1 = 0, cursor2 = base2, dest = base1;
+
+            a[dest++] = std::move(a[cursor2++]);
+            if (--length2 == 0) {
+                std::move(tmp + cursor1, tmp + cursor1 + length1, a + dest);
+                return;
+            }
+            if (length1 == 1) {
+                std::move(a + cursor2, a + cursor2 + length2, a + dest);
+                a[dest + length2] = std::move(tmp[cursor1]);
+                return;
+            }
+
+            ptrdiff_t gallop = minGallop;
+            while (true){
+                // One-at-a-time mode, until one run keeps winning.
+                ptrdiff_t count1 = 0, count2 = 0;
+                bool done = false;
+                do {
+                    if (comp(a[cursor2], tmp[cursor1])) {
+                        a[dest++] = std::move(a[cursor2++]);
+                        count2++;
+                        count1 = 0;
+                        if (--length2 == 0) { done = true; break; }
+                    }
+                    else {
+                        a[dest++] = std::move(tmp[cursor1++]);
+                        count1++;
+                        count2 = 0;
+                        if (--length1 == 1) { done = true; break; }
+                    }
+                } while ((count1 | count2) < gallop);
+                if (done) break;
+
+                // Galloping mode, while it keeps finding long stretches.
+                do {
+                    count1 = gallop_right(a[cursor2], tmp, cursor1, length1, 0);
+                    if (count1 != 0) {
+                        std::move(tmp + cursor1, tmp + cursor1 + count1, a + dest);
+                        dest += count1;
+                        cursor1 += count1;
+                        length1 -= count1;
+                        if (length1 <= 1) { done = true; break; }
+                    }
+                    a[dest++] = std::move(a[cursor2++]);
+                    if (--length2 == 0) { done = true; break; }
+
+                    count2 = gallop_left(tmp[cursor1], a, cursor2, length2, 0);
+                    if (count2 != 0) {
+                        std::move(a + cursor2, a + cursor2 + count2, a + dest);
+                        dest += count2;
+                        cursor2 += count2;
+                        length2 -= count2;
+                        if (length2 == 0) { done = true; break; }
+                    }
+                    a[dest++] = std::move(tmp[cursor1++]);
+                    if (--length1 == 1) { done = true; break; }
+                    gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+                if (done) break;
+                if (gallop < 0) gallop = 0;
+                gallop += 2; // Penalize leaving galloping mode.
+            }
+            minGallop = gallop < 1 ? 1 : gallop;
+
+            if (length1 == 1) {
+                std::move(a + cursor2, a + cursor2 + length2, a + dest);
+                a[dest + length2] = std::move(tmp[cursor1]);
+            }
+            else {
+                // length1 is only 0 here if comp isn't a strict weak ordering.
+                std::move(tmp + cursor1, tmp + cursor1 + length1, a + dest);
+            }
+        }
+
+        // Merges two runs when the second is the shorter, right to left with
+        // the second run moved out to the buffer.
+        void merge_hi(ptrdiff_t base1, ptrdiff_t length1, ptrdiff_t base2, ptrdiff_t length2){
+            T* tmp = ensure_buffer(length2);
+            std::move(a + base2, a + base2 + length2, tmp);
+            ptrdiff_t cursor1 = base1 + length1 - 1, cursor2 = length2 - 1, dest = base2 + length2 - 1;
+
+            a[dest--] = std::move(a[cursor1--]);
+            if (--length1 == 0) {
+                std::move(tmp, tmp + length2, a + dest - (length2 - 1));
+                return;
+            }
+            if (length2 == 1) {
+                dest -= length1;
+                cursor1 -= length1;
+                std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+                a[dest] = std::move(tmp[cursor2]);
+                return;
+            }
+
+            ptrdiff_t gallop = minGallop;
+            while (true){
+                ptrdiff_t count1 = 0, count2 = 0;
+                bool done = false;
+                do {
+                    if (comp(tmp[cursor2], a[cursor1])) {
+                        a[dest--] = std::move(a[cursor1--]);
+                        count1++;
+                        count2 = 0;
+                        if (--length1 == 0) { done = true; break; }
+                    }
+                    else {
+                        a[dest--] = std::move(tmp[cursor2--]);
+                        count2++;
+                        count1 = 0;
+                        if (--length2 == 1) { done = true; break; }
+                    }
+                } while ((count1 | count2) < gallop);
+                if (done) break;
+
+                do {
+                    count1 = length1 - gallop_right(tmp[cursor2], a, base1, length1, length1 - 1);
+                    if (count1 != 0) {
+                        dest -= count1;
+                        cursor1 -= count1;
+                        length1 -= count1;
+                        std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + count1, a + dest + 1 + count1);
+                        if (length1 == 0) { done = true; break; }
+                    }
+                    a[dest--] = std::move(tmp[cursor2--]);
+                    if (--length2 == 1) { done = true; break; }
+
+                    count2 = length2 - gallop_left(a[cursor1], tmp, 0, length2, length2 - 1);
+                    if (count2 != 0) {
+                        dest -= count2;
+                        cursor2 -= count2;
+                        length2 -= count2;
+                        std::move(tmp + cursor2 + 1, tmp + cursor2 + 1 + count2, a + dest + 1);
+                        if (length2 <= 1) { done = true; break; }
+                    }
+                    a[dest--] = std::move(a[cursor1--]);
+                    if (--length1 == 0) { done = true; break; }
+                    gallop--;
+                } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+                if (done) break;
+                if (gallop < 0) gallop = 0;
+                gallop += 2;
+            }
+            minGallop = gallop < 1 ? 1 : gallop;
+
+            if (length2 == 1) {
+                dest -= length1;
+                cursor1 -= length1;
+                std::move_backward(a + cursor1 + 1, a + cursor1 + 1 + length1, a + dest + 1 + length1);
+                a[dest] = std::move(tmp[cursor2]);
+            }
+            else {
+                std::move(tmp, tmp + length2, a + dest - (length2 - 1));
+            }
+        }
+    };
+
+    // Chunks smaller than this aren't worth a thread.
+    static const size_t PARALLEL_CHUNK_MIN = size_t(1) << 15;
+
+    // Calls task(0) .. task(count - 1), each on its own thread.
+    template <typename Task>
+    static void run_parallel(size_t count, Task task){
+        std::thread* workers = new std::thread[count - 1];
+        for (size_t t = 1; t < count; t++) workers[t - 1] = std::thread(task, t);
+        task(0);
+        for (size_t t = 1; t < count; t++) workers[t - 1].join();
+        delete[] workers;
+    }
+
+    // How many of the first k outputs of a stable merge of a and b come from a.
+    template <typename T, typename Compare>
+    static size_t merge_path(const T* a, size_t lengthA, const T* b, size_t lengthB, size_t k, Compare comp){
+        size_t lo = k > lengthB ? k - lengthB : 0;
+        size_t hi = k < lengthA ? k : lengthA;
+        while (lo < hi){
+            size_t i = lo + (hi - lo) / 2;
+            size_t j = k - i;
+            // a[i] is output before b[j - 1], so more of a belongs in the prefix.
+            if (j > 0 && !comp(b[j - 1], a[i])) lo = i + 1;
+            else hi = i;
+        }
+        return lo;
+    }
+
+    // Stable merge of [a, aEnd) and [b, bEnd), moved into out.
+    template <typename T, typename Compare>
+    static void merge_move(T* a, T* aEnd, T* b, T* bEnd, T* out, Compare comp){
+        while (a != aEnd && b != bEnd){
+            if (comp(*b, *a)) *out++ = std::move(*b++);
+            else *out++ = std::move(*a++);
+        }
+        while (a != aEnd) *out++ = std::move(*a++);
+        while (b != bEnd) *out++ = std::move(*b++);
+    }
+
+    static const size_t INSERTION_THRESHOLD = 24;
+    static const size_t NINTHER_THRESHOLD = 128;
+    static const size_t PARTIAL_INSERTION_LIMIT = 8;
+    static const size_t BLOCK_SIZE = 64;
+
+    static int floor_log2(size_t n){
+        int log = 0;
+        while (n >>= 1) log++;
+        return log;
+    }
+
+    template <typename T, typename Compare>
+    static void make_heap(T* heap, size_t n, Compare comp){
+        for (size_t i = n / 2; i-- > 0;) sift_down(heap, i, n, comp);
+    }
+    // Turns a max-heap into a sorted range.
+    template <typename T, typename Compare>
+    static void sort_heap(T* heap, size_t n, Compare comp){
+        for (size_t end = n; end-- > 1;){
+            std::swap(heap[0], heap[end]);
+            sift_down(heap, 0, end, comp);
+        }
+    }
+    // Heap-based partial sort, used by nth_element when quickselect
+    // degrades: keeps the smallest elements in a max-heap over [first, middle).
+    template <typename T, typename Compare>
+    static void partial_heap_sort(T* first, T* middle, T* last, Compare comp){
+        size_t k = middle - first;
+        make_heap(first, k, comp);
+        for (T* cur = middle; cur < last; cur++){
+            if (comp(*cur, *first)) {
+                std::swap(*cur, *first);
+                sift_down(first, 0, k, comp);
+            }
+        }
+        sort_heap(first, k, comp);
+    }
+
+    // Restores the max-heap property below index root, in a heap of n elements.
+    template <typename T, typename Compare>
+    static void sift_down(T* heap, size_t root, size_t n, Compare comp){
+        T value = std::move(heap[root]);
+        size_t child;
+        while ((child = 2 * root + 1) < n){
+            if (child + 1 < n && comp(heap[child], heap[child + 1])) child++;
+            if (!comp(value, heap[child])) break;
+            heap[root] = std::move(heap[child]);
+            root = child;
+        }
+        heap[root] = std::move(value);
+    }
+
+    // Same as insertion_sort, but the element before first must be no greater
+    // than anything in the range, which lets the inner loop skip a bounds check.
+    template <typename T, typename Compare>
+    static void unguarded_insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+            }
+        }
+    }
+
+    // Insertion sort that gives up after moving PARTIAL_INSERTION_LIMIT
+    // elements. Returns true if the range ended up sorted.
+    template <typename T, typename Compare>
+    static bool partial_insertion_sort(T* first, T* last, Compare comp){
+        if (first == last) return true;
+        size_t moved = 0;
+        for (T* cur = first + 1; cur != last; cur++){
+            T* sift = cur;
+            T* sift_1 = cur - 1;
+            if (comp(*sift, *sift_1)) {
+                T tmp = std::move(*sift);
+                do { *sift-- = std::move(*sift_1); } while (sift != first && comp(tmp, *--sift_1));
+                *sift = std::move(tmp);
+                moved += cur - sift;
+            }
+            if (moved > PARTIAL_INSERTION_LIMIT) return false;
+        }
+        return true;
+    }
+
+    // Sorts three elements in place so that *a <= *b <= *c.
+    template <typename T, typename Compare>
+    static void sort3(T* a, T* b, T* c, Compare comp){
+        if (comp(*b, *a)) std::swap(*a, *b);
+        if (comp(*c, *b)) std::swap(*b, *c);
+        if (comp(*b, *a)) std::swap(*a, *b);
+    }
+
+    // Partitions around the pivot at *first: smaller elements go left, equal
+    // and greater ones right. Returns the pivot's final position and whether
+    // the range was already partitioned.
+    template <typename T, typename Compare>
+    static std::pair<T*, bool> partition_right(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        // The pivot was a median, so some element >= pivot stops this scan.
+        while (comp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !comp(*--last, pivot));
+        else                    while (!comp(*--last, pivot));
+        bool alreadyPartitioned = first >= last;
+        while (first < last){
+            std::swap(*first, *last);
+            while (comp(*++first, pivot));
+            while (!comp(*--last, pivot));
+        }
+        T* pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return std::pair<T*, bool>(pivotPos, alreadyPartitioned);
+    }
+
+    // partition_right for cheap comparators. Comparison results are written
+    // into blocks of offsets instead of branched on, then misplaced elements
+    // are swapped in bulk (BlockQuicksort).
+    template <typename T, typename Compare>
+    static std::pair<T*, bool> partition_right_branchless(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        while (comp(*++first, pivot));
+        if (first - 1 == begin) while (first < last && !comp(*--last, pivot));
+        else                    while (!comp(*--last, pivot));
+        bool alreadyPartitioned = first >= last;
+        if (!alreadyPartitioned) {
+            std::swap(*first, *last);
+            first++;
+            unsigned char offsetsL[BLOCK_SIZE];
+            unsigned char offsetsR[BLOCK_SIZE];
+            T* baseL = first;
+            T* baseR = last;
+            size_t numL = 0, numR = 0, startL = 0, startR = 0;
+            while (first < last){
+                // Fill whichever offset block is empty, splitting what's left
+                // evenly if both are.
+                size_t unknown = last - first;
+                size_t splitL = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+                size_t splitR = numR == 0 ? unknown - splitL : 0;
+                if (splitL > BLOCK_SIZE) splitL = BLOCK_SIZE;
+                if (splitR > BLOCK_SIZE) splitR = BLOCK_SIZE;
+                for (size_t i = 0; i < splitL; i++){
+                    offsetsL[numL] = static_cast<unsigned char>(i);
+                    numL += !comp(*first, pivot);
+                    first++;
+                }
+                for (size_t i = 0; i < splitR;){
+                    offsetsR[numR] = static_cast<unsigned char>(++i);
+                    numR += comp(*--last, pivot);
+                }
+                size_t num = numL < numR ? numL : numR;
+                for (size_t i = 0; i < num; i++){
+                    std::swap(baseL[offsetsL[startL + i]], *(baseR - offsetsR[startR + i]));
+                }
+                numL -= num; numR -= num;
+                startL += num; startR += num;
+                if (numL == 0) { startL = 0; baseL = first; }
+                if (numR == 0) { startR = 0; baseR = last; }
+            }
+            // At most one block still has misplaced elements; move them to the
+            // boundary.
+            if (numL) {
+                while (numL--) std::swap(baseL[offsetsL[startL + numL]], *--last);
+                first = last;
+            }
+            if (numR) {
+                while (numR--) { std::swap(*(baseR - offsetsR[startR + numR]), *first); first++; }
+                last = first;
+            }
+        }
+        T* pivotPos = first - 1;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return std::pair<T*, bool>(pivotPos, alreadyPartitioned);
+    }
+
+    // Puts elements equal to the pivot at *first on the left. Used when the
+    // pivot equals the element before the range, so the left side is all equal
+    // and needs no further sorting. Returns the pivot's final position.
+    template <typename T, typename Compare>
+    static T* partition_left(T* begin, T* end, Compare comp){
+        T pivot(std::move(*begin));
+        T* first = begin;
+        T* last = end;
+        while (comp(pivot, *--last));
+        if (last + 1 == end) while (first < last && !comp(pivot, *++first));
+        else                 while (!comp(pivot, *++first));
+        while (first < last){
+            std::swap(*first, *last);
+            while (comp(pivot, *--last));
+            while (!comp(pivot, *++first));
+        }
+        T* pivotPos = last;
+        *begin = std::move(*pivotPos);
+        *pivotPos = std::move(pivot);
+        return pivotPos;
+    }
+
+    // Sorts [begin, end). badAllowed counts how many unbalanced partitions are
+    // tolerated before switching to heapsort. leftmost is false when the
+    // element before begin is known to be <= everything in the range.
+    template <typename T, typename Compare, bool Branchless>
+    static void introsort_loop(T* begin, T* end, Compare comp, int badAllowed, bool leftmost){
+        while (true){
+            size_t size = end - begin;
+            if (size < INSERTION_THRESHOLD) {
+                if (leftmost) insertion_sort(begin, end, comp);
+                else unguarded_insertion_sort(begin, end, comp);
+                return;
+            }
+
+            // Median of three, or Tukey's ninther for larger ranges, moved to *begin.
+            size_t s2 = size / 2;
+            if (size > NINTHER_THRESHOLD) {
+                sort3(begin, begin + s2, end - 1, comp);
+                sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+                sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+                sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+                std::swap(*begin, *(begin + s2));
+            }
+            else sort3(begin + s2, begin, end - 1, comp);
+
+            // Many equal elements: take them all out in one pass.
+            if (!leftmost && !comp(*(begin - 1), *begin)) {
+                begin = partition_left(begin, end, comp) + 1;
+                continue;
+            }
+
+            std::pair<T*, bool> result = Branchless ? partition_right_branchless(begin, end, comp)
+                                                    : partition_right(begin, end, comp);
+            T* pivotPos = result.first;
+            size_t sizeL = pivotPos - begin;
+            size_t sizeR = end - (pivotPos + 1);
+
+            if (sizeL < size / 8 || sizeR < size / 8) {
+                if (--badAllowed == 0) {
+                    heap_sort(begin, end, comp);
+                    return;
+                }
+                // Shuffle a few elements to break up whatever pattern caused
+                // the bad split.
+                if (sizeL >= INSERTION_THRESHOLD) {
+                    std::swap(*begin, *(begin + sizeL / 4));
+                    std::swap(*(pivotPos - 1), *(pivotPos - sizeL / 4));
+                    if (sizeL > NINTHER_THRESHOLD) {
+                        std::swap(*(begin + 1), *(begin + (sizeL / 4 + 1)));
+                        std::swap(*(begin + 2), *(begin + (sizeL / 4 + 2)));
+                        std::swap(*(pivotPos - 2), *(pivotPos - (sizeL / 4 + 1)));
+                        std::swap(*(pivotPos - 3), *(pivotPos - (sizeL / 4 + 2)));
+                    }
+                }
+                if (sizeR >= INSERTION_THRESHOLD) {
+                    std::swap(*(pivotPos + 1), *(pivotPos + (1 + sizeR / 4)));
+                    std::swap(*(end - 1), *(end - sizeR / 4));
+                    if (sizeR > NINTHER_THRESHOLD) {
+                        std::swap(*(pivotPos + 2), *(pivotPos + (2 + sizeR / 4)));
+                        std::swap(*(pivotPos + 3), *(pivotPos + (3 + sizeR / 4)));
+                        std::swap(*(end - 2), *(end - (1 + sizeR / 4)));
+                        std::swap(*(end - 3), *(end - (2 + sizeR / 4)));
+                    }
+                }
+            }
+            else {
+                // A balanced split that needed no swaps suggests sorted input;
+                // try to finish each side with a bounded insertion sort.
+                if (result.second && partial_insertion_sort(begin, pivotPos, comp)
+                                  && partial_insertion_sort(pivotPos + 1, end, comp)) return;
+            }
+
+            // Recurse into the left side and loop on the right.
+            introsort_loop<T, Compare, Branchless>(begin, pivotPos, comp, badAllowed, leftmost);
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+    }
+};
+
+/*
+    G_Snapshot is the binary file format G_Array and G_Dictionary save to and
+    load from, so a program can start from its last state without parsing
+    text. A file is a 64-byte header followed by the payload:
+        - arrays of trivially copyable elements: the elements as one raw block
+        - strings: a 32-bit length and then the bytes
+        - dictionaries: each key as a string, then its value
+    The header records the format version, what kind of container and
+    element the file holds, the element count, and a checksum over the
+    payload and the rest of the header. Every load checks all of them; a load
+    that skips the checksum still rejects a count the payload is too small to
+    hold, so a damaged header can't make the loader reserve absurd amounts.
+
+    Files are read through mmap where available. Because the header is 64
+    bytes, a raw element block is suitably aligned in the mapping, so
+    G_SnapshotView can hand out the elements in place without copying them.
+*/
+class G_Snapshot {
+public:
+    // Version 2 extended the checksum to cover the header.
+    static const uint32_t VERSION = 2;
+    static const uint32_t KIND_ARRAY = 1;
+    static const uint32_t KIND_DICTIONARY = 2;
+
+    struct Header {
+        char magic[4];          // "GSNP"
+        uint32_t version;
+        uint32_t kind;          // KIND_ARRAY or KIND_DICTIONARY
+        uint32_t elementType;   // element_type<T>() of the (value) elements
+        uint32_t elementSize;   // sizeof the elements, 0 for strings
+        uint32_t reserved;
+        uint64_t count;
+        uint64_t payloadBytes;
+        uint64_t checksum;
+        unsigned char padding[16];
+    };
+    static_assert(sizeof(Header) == 64, "G_Snapshot header must stay 64 bytes");
+
+    // Element types a snapshot can hold: std::string and trivially copyable
+    // types, which are written as raw bytes.
+    template <typename T>
+    static constexpr bool storable(){
+        return std::is_same<T, std::string>::value || std::is_trivially_copyable<T>::value;
+    }
+    // A coarse type tag, so loading a file of floats into an array of ints
+    // fails instead of reinterpreting the bits.
+    template <typename T>
+    static constexpr uint32_t element_type(){
+        if (std::is_same<T, std::string>::value) return 1;
+        if (std::is_floating_point<T>::value) return 2;
+        if (std::is_integral<T>::value) return std::is_signed<T>::value ? 3 : 4;
+        return 5;
+    }
+    template <typename T>
+    static constexpr uint32_t element_size(){
+        return std::is_same<T, std::string>::value ? 0 : sizeof(T);
+    }
+
+    // 64-bit checksum, eight bytes at a time on four independent lanes so it
+    // runs near memory speed.
+    static uint64_t checksum(const void* data, size_t bytes){
+        const uint64_t P1 = 0x9E3779B185EBCA87ull, P2 = 0xC2B2AE3D27D4EB4Full;
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        uint64_t lanes[4] = {P1, P2, ~P1, ~P2};
+        size_t i = 0;
+        for (; i + 32 <= bytes; i += 32){
+            for (int l = 0; l < 4; l++){
+                uint64_t word;
+                std::memcpy(&word, p + i + 8 * l, 8);
+                lanes[l] = rotl(lanes[l] ^ (word * P2), 31) * P1;
+            }
+        }
+        uint64_t h = bytes * P1;
+        for (int l = 0; l < 4; l++) h = rotl(h ^ lanes[l], 27) * P2;
+        for (; i < bytes; i++) h = rotl(h ^ p[i], 11) * P1;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        return h;
+    }
+
+    // Accumulates a payload of variable-length records.
+    class Writer {
+    public:
+        void put_raw(const void* data, size_t bytes){
+            bytes_.append(static_cast<const char*>(data), bytes);
+        }
+        void put_text(std::string_view text){
+            uint32_t length = static_cast<uint32_t>(text.size());
+            put_raw(&length, sizeof(length));
+            put_raw(text.data(), text.size());
+        }
+        template <typename T>
+        void put(const T& value){
+            if constexpr (std::is_same<T, std::string>::value) put_text(value);
+            else put_raw(&value, sizeof(T));
+        }
+        const char* data() const { return bytes_.data(); }
+        size_t size() const { return bytes_.size(); }
+    private:
+        std::string bytes_;
+    };
+    // Walks a payload written by Writer. Every read is bounds checked and
+    // returns false once the payload runs out.
+    class Reader {
+    public:
+        Reader(const unsigned char* data, size_t bytes) : cur(data), end(data + bytes) {}
+        bool get_raw(void* out, size_t bytes){
+            if (static_cast<size_t>(end - cur) < bytes) return false;
+            std::memcpy(out, cur, bytes);
+            cur += bytes;
+            return true;
+        }
+        // The view points into the payload, so nothing is copied.
+        bool get_text(std::string_view& text){
+            uint32_t length;
+            if (!get_raw(&length, sizeof(length)) || static_cast<size_t>(end - cur) < length) return false;
+            text = std::string_view(reinterpret_cast<const char*>(cur), length);
+            cur += length;
+            return true;
+        }
+        template <typename T>
+        bool get(T& value){
+            if constexpr (std::is_same<T, std::string>::value) {
+                std::string_view text;
+                if (!get_text(text)) return false;
+                value.assign(text.data(), text.size());
+                return true;
+            }
+            else return get_raw(&value, sizeof(T));
+        }
+        bool finished() const { return cur == end; }
+    private:
+        const unsigned char* cur;
+        const unsigned char* end;
+    };
+
+    // A whole file in memory: mapped read-only on Linux, read into a buffer
+    // elsewhere. Released when it goes out of scope.
+    class Mapping {
+    public:
+        Mapping() : bytes(nullptr), length(0), mapped(false) {}
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        ~Mapping(){ close(); }
+
+        bool open(const std::string& path){
+            close();
+#ifdef __linux__
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                ::close(fd);
+                return false;
+            }
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0) {
+                void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view == MAP_FAILED) {
+                    ::close(fd);
+                    length = 0;
+                    return false;
+                }
+                madvise(view, length, MADV_SEQUENTIAL);
+                bytes = static_cast<const unsigned char*>(view);
+                mapped = true;
+            }
+            ::close(fd);
+            return true;
+#else
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file) return false;
+            std::fseek(file, 0, SEEK_END);
+            long end = std::ftell(file);
+            std::fseek(file, 0, SEEK_SET);
+            length = end > 0 ? static_cast<size_t>(end) : 0;
+            unsigned char* buffer = static_cast<unsigned char*>(::operator new(length ? length : 1));
+            bool ok = std::fread(buffer, 1, length, file) == length;
+            std::fclose(file);
+            bytes = buffer;
+            if (!ok) close();
+            return ok;
+#endif
+        }
+        void close(){
+            if (!bytes) return;
+#ifdef __linux__
+            if (mapped) munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+            if (!mapped) ::operator delete(const_cast<unsigned char*>(bytes));
+            bytes = nullptr;
+            length = 0;
+            mapped = false;
+        }
+        const unsigned char* data() const { return bytes; }
+        size_t size() const { return length; }
+    private:
+        const unsigned char* bytes;
+        size_t length;
+        bool mapped;
+    };
+
+    static Header make_header(uint32_t kind, uint32_t elementType, uint32_t elementSize,
+                              uint64_t count, const void* payload, size_t payloadBytes){
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "GSNP", 4);
+        header.version = VERSION;
+        header.kind = kind;
+        header.elementType = elementType;
+        header.elementSize = elementSize;
+        header.count = count;
+        header.payloadBytes = payloadBytes;
+        header.checksum = sealed_checksum(header, payload);
+        return header;
+    }
+    // Writes header and payload to path, replacing it only once the new file
+    // is complete, so a failed save leaves the old snapshot intact.
+    static bool write_file(const std::string& path, const Header& header, const void* payload){
+        std::string temporary = path + ".tmp";
+        std::FILE* out = std::fopen(temporary.c_str(), "wb");
+        if (!out) {
+            std::cout << "Couldn't open " << temporary << " for writing.\n";
+            return false;
+        }
+        bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  (header.payloadBytes == 0 || std::fwrite(payload, 1, header.payloadBytes, out) == header.payloadBytes);
+        ok = std::fclose(out) == 0 && ok;
+        if (ok) ok = std::rename(temporary.c_str(), path.c_str()) == 0;
+        if (!ok) {
+            std::remove(temporary.c_str());
+            std::cout << "Couldn't write snapshot " << path << ".\n";
+        }
+        return ok;
+    }
+    // Maps path and checks that it is an intact snapshot of the expected
+    // kind. Returns the payload, or nullptr after printing what was wrong.
+    // verify = false skips the checksum, which reads the whole payload.
+    static const unsigned char* open_file(Mapping& file, const std::string& path, uint32_t kind,
+                                          uint32_t elementType, uint32_t elementSize,
+                                          Header& header, bool verify = true){
+        if (!file.open(path)) {
+            std::cout << "Couldn't open snapshot " << path << ".\n";
+            return nullptr;
+        }
+        const char* problem = nullptr;
+        if (file.size() < sizeof(Header)) problem = "too short";
+        else {
+            std::memcpy(&header, file.data(), sizeof(Header));
+            const unsigned char* payload = file.data() + sizeof(Header);
+            if (std::memcmp(header.magic, "GSNP", 4) != 0) problem = "not a snapshot";
+            else if (header.version != VERSION) problem = "from an unsupported version";
+            else if (header.kind != kind || header.elementType != elementType || header.elementSize != elementSize)
+                problem = "holding a different container or element type";
+            else if (header.payloadBytes != file.size() - sizeof(Header)) problem = "truncated";
+            else if (header.count > header.payloadBytes / min_entry_bytes(kind, elementSize)) problem = "inconsistent";
+            else if (elementSize && kind == KIND_ARRAY && header.payloadBytes != header.count * elementSize)
+                problem = "inconsistent";
+            else if (verify && sealed_checksum(header, payload) != header.checksum) problem = "corrupt (checksum mismatch)";
+        }
+        if (problem) {
+            std::cout << "Snapshot " << path << " is " << problem << ".\n";
+            file.close();
+            return nullptr;
+        }
+        return file.data() + sizeof(Header);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int r){
+        return (x << r) | (x >> (64 - r));
+    }
+    // The payload's checksum folded together with every other header field,
+    // so a damaged count or type tag fails verification too.
+    static uint64_t sealed_checksum(Header header, const void* payload){
+        header.checksum = checksum(payload, header.payloadBytes);
+        return checksum(&header, sizeof(header));
+    }
+    // Fewest payload bytes one entry can take: raw elements are elementSize
+    // each, strings at least their 32-bit length, dictionary entries a key
+    // plus a value. Bounding count by payloadBytes / this also keeps
+    // count * elementSize from overflowing.
+    static uint64_t min_entry_bytes(uint32_t kind, uint32_t elementSize){
+        uint64_t value = elementSize ? elementSize : sizeof(uint32_t);
+        return kind == KIND_DICTIONARY ? sizeof(uint32_t) + value : value;
+    }
+};
+
 /*
     G_Array is a templated array that automatically resizes to fit data added, 
     and can scale down when elements are removed (only supports removal from
     last indice).
 
-    November 17: Added the sort method, fixed an off-by-one error in add_element.
-    Dec 3: Cleaned up removal methods substantially.
+    November 17: Added the sort method, fixed an off-by-one error in add_element.
+    Dec 3: Cleaned up removal methods substantially.
+    October 19: Added find, count, contains and find_if. Arithmetic types are
+    searched with the G_Simd kernels.
+    October 19: Storage now comes from an allocation policy (see
+    G_HugePageAllocator) and grows by doubling, so add_element no longer copies
+    the whole array every call.
+    October 19: sort is an introsort now instead of a bubble sort.
+    October 19: Added radix_sort, which sort uses for large arrays of numbers.
+    October 19: Added parallel_sort.
+    October 19: Added stable_sort. sort is no longer stable, so callers that
+    depend on equal elements keeping their order should use it.
+    October 19: Added sort_by_key for comparators with expensive keys.
+    October 19: Added nth_element, partial_sort and top_k.
+    October 19: Added insert_element_at.
+    October 19: Added save_snapshot and load_snapshot (see G_Snapshot).
+*/
+template <typename T, typename Compare, typename Allocator>
+class G_SortedArray;
+template <typename K, typename V, typename Compare, typename Allocator>
+class G_FlatMap;
+
+template <typename T, typename Allocator = G_HeapAllocator>
+class G_Array{
+private:
+    // The sorted containers shift and merge elements in place.
+    template <typename, typename, typename> friend class G_SortedArray;
+    template <typename, typename, typename, typename> friend class G_FlatMap;
+
+    T* array;
+    size_t size;
+    size_t capacity;
+
+    // Moves the elements into a block of newCapacity slots from the allocator.
+    void reallocate(size_t newCapacity){
+        T* pTmp = newCapacity ? static_cast<T*>(Allocator::allocate(newCapacity * sizeof(T))) : nullptr;
+        for (size_t i = 0; i < size; i++){
+            new (pTmp + i) T(std::move(array[i]));
+            array[i].~T();
+        }
+        if (array) Allocator::deallocate(array, capacity * sizeof(T));
+        array = pTmp;
+        capacity = newCapacity;
+    }
+    // Gives memory back once the array is down to a quarter of its capacity.
+    void shrink_if_sparse(){
+        if (capacity > 8 && size <= capacity / 4) reallocate(capacity / 2);
+    }
+
+public:
+    // Constructor initializes an array of size 0 and a size tracker.
+    G_Array() : array(nullptr), size(0), capacity(0) {}
+    G_Array(const G_Array& other) : array(nullptr), size(0), capacity(0) {
+        reserve(other.size);
+        for (size_t i = 0; i < other.size; i++) new (array + i) T(other.array[i]);
+        size = other.size;
+    }
+    // Builds an array holding a copy of count elements starting at data.
+    G_Array(const T* data, size_t count) : array(nullptr), size(0), capacity(0) {
+        reserve(count);
+        for (size_t i = 0; i < count; i++) new (array + i) T(data[i]);
+        size = count;
+    }
+    G_Array& operator=(const G_Array& other){
+        if (this != &other) {
+            clear();
+            reserve(other.size);
+            for (size_t i = 0; i < other.size; i++) new (array + i) T(other.array[i]);
+            size = other.size;
+        }
+        return *this;
+    }
+    // Destructor to free array on leaving scope.
+    ~G_Array() {
+        clear();
+        if (array) Allocator::deallocate(array, capacity * sizeof(T));
+    }
+
+    // Makes room for at least newCapacity elements without changing the size.
+    // Loaders that know their record count should call this first.
+    void reserve(size_t newCapacity){
+        if (newCapacity > capacity) reallocate(newCapacity);
+    }
+    // Destroys every element but keeps the allocation.
+    void clear(){
+        for (size_t i = 0; i < size; i++) array[i].~T();
+        size = 0;
+    }
+
+    // Adding to the array is done through the add_element function, which
+    // abstracts away all the resizing done.
+    void add_element(T newElement){
+        Logger l = Logger("add_element");
+        if (size == capacity) reallocate(capacity ? capacity * 2 : 4);
+        new (array + size) T(std::move(newElement));
+        size++;
+    }
+    // Inserts newElement before index, shifting later elements back.
+    // Returns false if index is past the end.
+    bool insert_element_at(int index, T newElement){
+        Logger l = Logger("insert_element_at");
+        if (index < 0 || static_cast<size_t>(index) > size){
+            std::cout << "Attempted to insert at index not within array.\n";
+            return false;
+        }
+        if (size == capacity) reallocate(capacity ? capacity * 2 : 4);
+        if (static_cast<size_t>(index) == size) new (array + size) T(std::move(newElement));
+        else {
+            new (array + size) T(std::move(array[size - 1]));
+            for (size_t i = size - 1; i > static_cast<size_t>(index); i--) array[i] = std::move(array[i - 1]);
+            array[index] = std::move(newElement);
+        }
+        size++;
+        return true;
+    }
+    // Remove the last element of the array
+    bool remove_last(){
+        Logger l = Logger("remove_element");
+        if (size == 0) return false;
+        size--;
+        array[size].~T();
+        shrink_if_sparse();
+        return true;
+    }
+    // Remove a specified array element
+    // Returns false if removal was unsuccessful
+    bool remove_element(const T& target){
+        int targetIndex = find(target);
+        if (targetIndex == -1) return false;
+        remove_element_at(targetIndex);
+        return true;
+    }
+    // Removes a specified index from array
+    // Returns false if index out of bounds
+    bool remove_element_at(int index){
+        Logger l = Logger("remove_element_at");
+        if (index < 0 || static_cast<size_t>(index) >= size){
+            std::cout << "Attempted to remove index not within array.\n";
+            return false;
+        }
+        for (size_t i = index; i + 1 < size; i++) {
+            array[i] = std::move(array[i + 1]);
+        }
+        size--;
+        array[size].~T();
+        shrink_if_sparse();
+        return true;
+    }
+    // Overloading the [] operator to allow G_Array[idx] calls, rather
+    // than entire function calls written out. 
+    T& operator[](size_t index){
+        Logger l = Logger("[] operator");
+        if (index >= size){
+            std::cout << "Attempting to access an out of bounds indice.\n";
+            exit(0);
+        }
+        else
+            return array[index];
+    }
+
+    size_t length(){
+        Logger l = Logger("length");
+        return size;
+    }
+
+    // Read-only view of the elements, for bulk reads that shouldn't log
+    // every access.
+    const T* data() const {
+        return array;
+    }
+    // The same, writable, for algorithms that work on the raw storage.
+    T* data(){
+        return array;
+    }
+
+    // Bytes of the mapping holding this array's storage that the kernel has
+    // backed with huge pages. G_HugePageAllocator asks for them on large
+    // arrays, but with transparent huge pages set to "always" a large heap
+    // block can report some too.
+    size_t huge_page_bytes() const {
+        return array ? G_HugePageAllocator::huge_page_bytes(array) : 0;
+    }
+
+    // Search functions. These read the array directly rather than going
+    // through operator[], so a scan doesn't log once per element.
+    // Returns the index of the first element equal to target, or -1.
+    int find(const T& target) const {
+        size_t index = G_Simd::find(array, size, target);
+        return index == size ? -1 : static_cast<int>(index);
+    }
+    // Returns how many elements are equal to target.
+    size_t count(const T& target) const {
+        return G_Simd::count(array, size, target);
+    }
+    bool contains(const T& target) const {
+        return find(target) != -1;
+    }
+    // Returns the index of the first element for which pred is true, or -1.
+    template <typename Predicate>
+    int find_if(Predicate pred) const {
+        for (size_t i = 0; i < size; i++){
+            if (pred(array[i])) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    void display(){
+        for (int i = 0; i < size; i++){
+            std::cout << array[i] << ' ';
+        }
+    }
+
+    // Sort function using a functor for comparison
+    // Introsort through G_Sort, O(n log n) worst case. Large arrays of numbers
+    // sorted with one of the stock functors are radix sorted instead.
+    template <typename Compare>
+    void sort(Compare comp) {
+        G_Sort::sort(array, array + size, comp);
+    }
+    // Stable sort: elements that compare equal keep their current order.
+    // Cheap on arrays that are already mostly sorted or reversed.
+    template <typename Compare>
+    void stable_sort(Compare comp) {
+        G_Sort::timsort(array, array + size, comp);
+    }
+    // Multi-threaded sort for very large arrays. threads = 0 uses every core.
+    // Falls back to sort() when the array is too small to split.
+    template <typename Compare>
+    void parallel_sort(Compare comp, unsigned threads = 0) {
+        Logger l = Logger("parallel_sort");
+        if (size < G_Sort::PARALLEL_THRESHOLD) {
+            sort(comp);
+            return;
+        }
+        G_Sort::parallel_merge_sort(array, array + size, comp, threads);
+    }
+    // Selection, for when only part of the order matters. Orders are the
+    // same as sort(comp) would give.
+    // Puts the element that belongs at index n there, with everything that
+    // belongs before it in front and everything after it behind. O(n).
+    template <typename Compare>
+    void nth_element(size_t n, Compare comp) {
+        if (n < size) G_Sort::nth_element(array, array + n, array + size, comp);
+    }
+    // Sorts only the first k positions; the rest are left in no order.
+    template <typename Compare>
+    void partial_sort(size_t k, Compare comp) {
+        G_Sort::partial_sort(array, array + (k < size ? k : size), array + size, comp);
+    }
+    // Returns the first k elements a sort would give, in order, leaving this
+    // array untouched.
+    template <typename Compare>
+    G_Array top_k(size_t k, Compare comp) const {
+        G_Array best;
+        if (k > size) k = size;
+        best.reserve(k);
+        for (size_t i = 0; i < k; i++) new (best.array + i) T(array[i]);
+        best.size = k;
+        G_Sort::top_k(array, array + size, best.array, k, comp);
+        return best;
+    }
+    // Sorts by a key computed once per element, e.g.
+    //     items.sort_by_key([](const Item& i){ return i.get_ID(); }, Descending<int>());
+    // comp compares two keys. Equal keys keep their order.
+    template <typename Projection, typename Compare>
+    void sort_by_key(Projection proj, Compare comp) {
+        G_Sort::sort_by_key(array, array + size, proj, comp);
+    }
+    // Stable LSD radix sort for arrays of numbers, ascending by default.
+    void radix_sort(bool descending = false) {
+        G_Sort::radix_sort(array, array + size, descending);
+    }
+    // Stable radix sort by a numeric key, which proj computes once per element.
+    template <typename Projection>
+    void radix_sort_by_key(Projection proj, bool descending = false) {
+        G_Sort::radix_sort_by_key(array, array + size, proj, descending);
+    }
+
+    // Writes the array to path as a G_Snapshot. Elements must be trivially
+    // copyable (written as one raw block) or std::string.
+    bool save_snapshot(const std::string& path) const {
+        Logger l = Logger("save_snapshot");
+        static_assert(G_Snapshot::storable<T>(), "snapshots hold std::string or trivially copyable elements");
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            G_Snapshot::Header header = G_Snapshot::make_header(G_Snapshot::KIND_ARRAY,
+                G_Snapshot::element_type<T>(), sizeof(T), size, array, size * sizeof(T));
+            return G_Snapshot::write_file(path, header, array);
+        }
+        else {
+            G_Snapshot::Writer writer;
+            for (size_t i = 0; i < size; i++) writer.put(array[i]);
+            G_Snapshot::Header header = G_Snapshot::make_header(G_Snapshot::KIND_ARRAY,
+                G_Snapshot::element_type<T>(), 0, size, writer.data(), writer.size());
+            return G_Snapshot::write_file(path, header, writer.data());
+        }
+    }
+    // Replaces the contents with a snapshot written by save_snapshot.
+    // Returns false, leaving the array empty, if the file is missing or bad.
+    bool load_snapshot(const std::string& path){
+        Logger l = Logger("load_snapshot");
+        static_assert(G_Snapshot::storable<T>(), "snapshots hold std::string or trivially copyable elements");
+        clear();
+        G_Snapshot::Mapping file;
+        G_Snapshot::Header header;
+        const unsigned char* payload = G_Snapshot::open_file(file, path, G_Snapshot::KIND_ARRAY,
+            G_Snapshot::element_type<T>(), G_Snapshot::element_size<T>(), header);
+        if (!payload) return false;
+        reserve(header.count);
+        if constexpr (std::is_trivially_copyable<T>::value) {
+            if (header.count) std::memcpy(static_cast<void*>(array), payload, header.count * sizeof(T));
+            size = header.count;
+            return true;
+        }
+        else {
+            G_Snapshot::Reader reader(payload, header.payloadBytes);
+            T value;
+            for (uint64_t i = 0; i < header.count; i++){
+                if (!reader.get(value)) break;
+                new (array + size) T(std::move(value));
+                size++;
+            }
+            if (size == header.count && reader.finished()) return true;
+            std::cout << "Snapshot " << path << " is inconsistent.\n";
+            clear();
+            return false;
+        }
+    }
+
+    void ComponentTest(){
+        std::cout << "Beginning Component testing of G_Array class template.\n";
+        std::cout << "Length: " << length() << '\n';
+        std::cout << "Adding element.\n";
+        add_element(T());
+        std::cout << "Length: " << length() << '\n';
+        std::cout << "Removing element.\n";
+        remove_last();
+        std::cout << "Length: " << length() << '\n';
+        std::cout << "Completed component test of G_Array\n\n";
+    }
+};
+
+/*
+    G_SnapshotView reads an array snapshot of trivially copyable elements in
+    place. open() maps the file and validates it, and data() then points
+    straight into the mapping, so startup costs an mmap and a checksum pass
+    rather than a parse and a copy. Trusted files can skip the checksum with
+    verify = false, making open() independent of the file's size.
+*/
+template <typename T>
+class G_SnapshotView {
+    static_assert(std::is_trivially_copyable<T>::value, "G_SnapshotView needs trivially copyable elements");
+public:
+    G_SnapshotView() : elements(nullptr), count(0) {}
+
+    bool open(const std::string& path, bool verify = true){
+        Logger l = Logger("G_SnapshotView open");
+        elements = nullptr;
+        count = 0;
+        G_Snapshot::Header header;
+        const unsigned char* payload = G_Snapshot::open_file(file, path, G_Snapshot::KIND_ARRAY,
+            G_Snapshot::element_type<T>(), sizeof(T), header, verify);
+        if (!payload) return false;
+        elements = reinterpret_cast<const T*>(payload);
+        count = header.count;
+        return true;
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= count){
+            std::cout << "Attempting to access an out of bounds indice.\n";
+            exit(0);
+        }
+        return elements[index];
+    }
+    const T* data() const {
+        return elements;
+    }
+    size_t length() const {
+        return count;
+    }
+
+private:
+    G_Snapshot::Mapping file;
+    const T* elements;
+    size_t count;
+};
+
+
+
+/*
+    The following three functors define three sorting methods-- ascending, descending,
+    and absolute ascending. Ascending sorts from least to greatest, descending from 
+    greatest to least. Absolute Ascending sorts from least to greatest, but considers
+    the absolute values of the inputs, not the true values. AKA it sorts by 
+    "intensity"
+    Arguments are taken by const reference so sorting strings or records
+    doesn't copy two elements per comparison.
+*/
+template <typename T>
+struct Ascending{
+    // Overloading () to make this struct a functor
+    bool operator()(const T& a, const T& b) const {
+        return a > b; // For descending order, essentially returning true IF a is greater than b
+    }
+};
+
+template <typename T>
+struct Descending{
+    // Overloading () to make this struct a functor
+    bool operator()(const T& a, const T& b) const {
+        return b > a; // For ascending, true IF b greater than a
+    }
+};
+
+template <typename T>
+struct AbsoluteValueComparison{
+    // overloading () to make this a functor
+    bool operator()(const T& a, const T& b) const {
+        return std::abs(a) < std::abs(b); // return true IF abs(a) greater than abs(b)
+    }
+};
+// Arithmetic comparisons are cheap, so let G_Sort partition them branchlessly.
+template <typename T>
+struct G_CheapCompare<Ascending<T>> : std::is_arithmetic<T> {};
+template <typename T>
+struct G_CheapCompare<Descending<T>> : std::is_arithmetic<T> {};
+template <typename T>
+struct G_CheapCompare<AbsoluteValueComparison<T>> : std::is_arithmetic<T> {};
+// Note the names: Ascending orders largest first and Descending smallest first.
+template <typename T>
+struct G_RadixOrder<Ascending<T>> {
+    typedef T value_type;
+    static const bool supported = G_Sort::radix_sortable<T>();
+    static const bool descending = true;
+    static const bool byMagnitude = false;
+};
+template <typename T>
+struct G_RadixOrder<Descending<T>> {
+    typedef T value_type;
+    static const bool supported = G_Sort::radix_sortable<T>();
+    static const bool descending = false;
+    static const bool byMagnitude = false;
+};
+template <typename T>
+struct G_RadixOrder<AbsoluteValueComparison<T>> {
+    typedef T value_type;
+    static const bool supported = G_Sort::radix_sortable<T>();
+    static const bool descending = false;
+    static const bool byMagnitude = true;
+};
+/*
+    G_SortedArray keeps its elements in the order Compare gives (smallest first
+    with the default Descending, same as G_Array::sort), so lookups are binary
+    searches instead of scans. Equal elements stay in the order they were
+    inserted.
+
+    insert costs an O(log n) search plus a shift to open the slot. To add many
+    elements at once use insert_bulk, which appends the batch, sorts just the
+    batch and merges it into place in a single pass.
+
+    Searches are branchless (see G_Sort::partition_point). For large arrays that are
+    searched much more often than changed, build_eytzinger() keeps a second
+    copy in breadth-first order, where the top levels of every search share a
+    few cache lines and the next levels can be prefetched. Any change to the
+    array drops that copy.
+*/
+template <typename T, typename Compare = Descending<T>, typename Allocator = G_HeapAllocator>
+class G_SortedArray {
+private:
+    G_Array<T, Allocator> items;
+    Compare comp;
+    // Eytzinger copy of items: slot k - 1 holds node k, whose children are
+    // nodes 2k and 2k + 1. treeIndex maps each slot back to its index.
+    G_Array<T, Allocator> tree;
+    G_Array<size_t, Allocator> treeIndex;
+    bool treeBuilt;
+
+    // How far ahead (in nodes) the Eytzinger search prefetches: four levels
+    // down, a cache line's worth of nodes are adjacent.
+    static constexpr size_t PREFETCH_DISTANCE = 16;
+
+    // Makes sure there is room for extra more elements.
+    void make_room(size_t extra){
+        size_t needed = items.size + extra;
+        if (needed <= items.capacity) return;
+        size_t grown = items.capacity ? items.capacity * 2 : 4;
+        items.reallocate(grown > needed ? grown : needed);
+    }
+    void drop_eytzinger(){
+        if (!treeBuilt) return;
+        tree.clear();
+        tree.reallocate(0);
+        treeIndex.clear();
+        treeIndex.reallocate(0);
+        treeBuilt = false;
+    }
+    // In-order walk of the implicit tree, handing out elements in sorted order.
+    void fill_tree(size_t node, size_t& next){
+        if (node > items.size) return;
+        fill_tree(2 * node, next);
+        new (tree.array + node - 1) T(items.array[next]);
+        treeIndex.array[node - 1] = next++;
+        fill_tree(2 * node + 1, next);
+    }
+
+    // Returns the first index whose element fails goesRight. goesRight must
+    // hold for a prefix of the array and fail for the rest.
+    template <typename Predicate>
+    size_t partition_point(Predicate goesRight) const {
+        if (treeBuilt) return tree_partition_point(goesRight);
+        return G_Sort::partition_point(items.array, items.array + items.size, goesRight) - items.array;
+    }
+    template <typename Predicate>
+    size_t tree_partition_point(Predicate goesRight) const {
+        const T* nodes = tree.array;
+        size_t n = tree.size;
+        size_t node = 1;
+        while (node <= n){
+#if defined(__GNUC__) || defined(__clang__)
+            if (node * PREFETCH_DISTANCE <= n) __builtin_prefetch(nodes + node * PREFETCH_DISTANCE - 1);
+#endif
+            node = 2 * node + goesRight(nodes[node - 1]);
+        }
+        // The walk fell off the bottom. The answer is the last node where it
+        // went left: drop the trailing right turns, then that left turn.
+        while (node & 1) node >>= 1;
+        node >>= 1;
+        return node ? treeIndex.array[node - 1] : items.size;
+    }
+
+    // Merges the sorted tail starting at index mid into the sorted front,
+    // working backwards so only the tail needs a buffer.
+    void merge_tail(size_t mid){
+        T* a = items.array;
+        size_t total = items.size;
+        if (mid == 0 || mid == total || !comp(a[mid], a[mid - 1])) return;
+        size_t tailCount = total - mid;
+        G_Array<T, Allocator> buffer;
+        buffer.reserve(tailCount);
+        for (size_t i = 0; i < tailCount; i++) new (buffer.array + i) T(std::move(a[mid + i]));
+        buffer.size = tailCount;
+        size_t left = mid, right = tailCount, out = total;
+        while (left > 0 && right > 0){
+            // Ties take the batch element first, so it lands after the old one.
+            if (comp(buffer.array[right - 1], a[left - 1])) a[--out] = std::move(a[--left]);
+            else a[--out] = std::move(buffer.array[--right]);
+        }
+        while (right > 0) a[--out] = std::move(buffer.array[--right]);
+    }
+
+public:
+    G_SortedArray(Compare comp = Compare()) : comp(comp), treeBuilt(false) {}
+    // Builds from count elements starting at data, in any order.
+    G_SortedArray(const T* data, size_t count, Compare comp = Compare()) : comp(comp), treeBuilt(false) {
+        insert_bulk(data, count);
+    }
+
+    // Adds value after any elements equal to it.
+    void insert(T value){
+        drop_eytzinger();
+        size_t pos = upper_bound(value);
+        items.insert_element_at(static_cast<int>(pos), std::move(value));
+    }
+    // Adds count elements starting at data, in any order. O(m log m + n) for
+    // m new elements, against O(m * n) for inserting them one at a time.
+    void insert_bulk(const T* data, size_t count){
+        Logger l = Logger("insert_bulk");
+        if (count == 0) return;
+        drop_eytzinger();
+        make_room(count);
+        size_t mid = items.size;
+        for (size_t i = 0; i < count; i++) new (items.array + mid + i) T(data[i]);
+        items.size += count;
+        G_Sort::timsort(items.array + mid, items.array + items.size, comp);
+        merge_tail(mid);
+    }
+    void insert_bulk(const G_Array<T, Allocator>& batch){
+        insert_bulk(batch.array, batch.size);
+    }
+
+    // Removes one element equal to value. Returns false if there was none.
+    bool erase(const T& value){
+        int index = find(value);
+        if (index == -1) return false;
+        return erase_at(index);
+    }
+    // Removes the element at index. Returns false if index is out of bounds.
+    bool erase_at(size_t index){
+        if (index >= items.size) return false;
+        drop_eytzinger();
+        return items.remove_element_at(static_cast<int>(index));
+    }
+    void clear(){
+        drop_eytzinger();
+        items.clear();
+    }
+
+    // Searches. Each is O(log n) and returns an index into the array.
+    // First element not before value.
+    size_t lower_bound(const T& value) const {
+        return partition_point([&](const T& x){ return comp(x, value); });
+    }
+    // First element after value.
+    size_t upper_bound(const T& value) const {
+        return partition_point([&](const T& x){ return !comp(value, x); });
+    }
+    // The [first, second) range of elements equal to value.
+    std::pair<size_t, size_t> equal_range(const T& value) const {
+        return std::make_pair(lower_bound(value), upper_bound(value));
+    }
+    // Index of the first element equal to value, or -1, like G_Array::find.
+    int find(const T& value) const {
+        size_t index = lower_bound(value);
+        if (index == items.size || comp(value, items.array[index])) return -1;
+        return static_cast<int>(index);
+    }
+    bool contains(const T& value) const {
+        return find(value) != -1;
+    }
+    size_t count(const T& value) const {
+        return upper_bound(value) - lower_bound(value);
+    }
+
+    // Lays out the Eytzinger copy used by later searches. Worth it for large
+    // arrays with many lookups between changes; costs a second copy of the
+    // elements.
+    void build_eytzinger(){
+        Logger l = Logger("build_eytzinger");
+        drop_eytzinger();
+        tree.reserve(items.size);
+        treeIndex.reserve(items.size);
+        size_t next = 0;
+        fill_tree(1, next);
+        tree.size = items.size;
+        treeIndex.size = items.size;
+        treeBuilt = true;
+    }
+
+    // Element access doesn't log, since searches read elements constantly.
+    const T& operator[](size_t index) const {
+        if (index >= items.size){
+            std::cout << "Attempting to access an out of bounds indice.\n";
+            exit(0);
+        }
+        return items.array[index];
+    }
+    size_t length() const {
+        return items.size;
+    }
+    const T* data() const {
+        return items.array;
+    }
+};
+/*
+    G_FlatMap maps keys of any type to values, for tables that are built once
+    and then mostly read: command tables, settings, static lookups. Keys and
+    values sit in two parallel arrays sorted by key, with no hash slots or
+    per-node pointers, so it takes about as little memory as the data itself.
+
+    build() fills it from unsorted input in one O(n log n) pass; lookups are
+    O(log n) binary searches; index i walks the entries in key order, and
+    range() gives the indices of every key between two bounds. Single inserts
+    and erases work but shift the arrays, so they are O(n).
+
+    Keys are ordered by Compare, smallest first with the default Descending.
+    Each key appears once; when build() sees a key twice the later value wins.
 */
-template <typename T>
-class G_Array{
+template <typename K, typename V, typename Compare = Descending<K>, typename Allocator = G_HeapAllocator>
+class G_FlatMap {
 private:
-    T* array;
-    size_t size;
+    G_Array<K, Allocator> keys;
+    G_Array<V, Allocator> values;
+    Compare comp;
 
-    // Helper function to swap elements
-    void swap(T& a, T& b) {
-        T temp = a;
-        a = b;
-        b = temp;
+    bool key_at_matches(size_t index, const K& key) const {
+        return index < keys.size && !comp(key, keys.array[index]);
     }
 
 public:
-    // Constructor initializes an array of size 0 and a size tracker.
-    G_Array : array(new T[0]), size(0) {}
-    // Destructor to free array on leaving scope.
-    ~G_Array {
-        delete[] array;
+    G_FlatMap(Compare comp = Compare()) : comp(comp) {}
+    // Builds the map from count parallel keys and values in any order.
+    G_FlatMap(const K* keyData, const V* valueData, size_t count, Compare comp = Compare()) : comp(comp) {
+        build(keyData, valueData, count);
     }
 
-    // Adding to the array is done through the add_element function, which
-    // abstracts away all the resizing done.
-    void add_element(T newElement){
-        Logger l = Logger("add_element");
-        size++;
-        T* pTmp = new T[size];
-        for (int i = 0; i < size; i++){
-            pTmp[i] = array[i];
+    // Replaces the contents with count parallel keys and values in any order.
+    // Sorts a list of indices rather than the entries, so each key and value
+    // is copied exactly once.
+    void build(const K* keyData, const V* valueData, size_t count){
+        Logger l = Logger("build");
+        clear();
+        G_Array<size_t> order;
+        order.reserve(count);
+        for (size_t i = 0; i < count; i++) order.array[i] = i;
+        order.size = count;
+        // Stable, so duplicates stay in input order and the last one wins below.
+        G_Sort::timsort(order.array, order.array + count,
+            [&](size_t a, size_t b){ return comp(keyData[a], keyData[b]); });
+        keys.reserve(count);
+        values.reserve(count);
+        for (size_t i = 0; i < count; i++){
+            size_t from = order.array[i];
+            if (keys.size && !comp(keys.array[keys.size - 1], keyData[from])) {
+                values.array[values.size - 1] = valueData[from];
+                continue;
+            }
+            new (keys.array + keys.size++) K(keyData[from]);
+            new (values.array + values.size++) V(valueData[from]);
         }
-        pTmp[size - 1] = newElement;
-        delete[] array;
-        array = pTmp;
     }
-    // Remove the last element of the array
-    bool remove_last(){
-        Logger l = Logger("remove_element");
-        if (size == 0) return false
-        size--;
-        T* pTmp = new T[size];
-        for (int i = 0; i < size; i++){
-            pTmp[i] = array[i];
+
+    // Sets key's value, adding key if it's new. O(n) for a new key.
+    void insert_or_assign(K key, V value){
+        size_t index = lower_bound(key);
+        if (key_at_matches(index, key)) {
+            values.array[index] = std::move(value);
+            return;
         }
-        delete[] array;
-        array = pTmp;
+        keys.insert_element_at(static_cast<int>(index), std::move(key));
+        values.insert_element_at(static_cast<int>(index), std::move(value));
+    }
+    // Removes key and returns true, or returns false if it wasn't present.
+    bool erase(const K& key){
+        size_t index = lower_bound(key);
+        if (!key_at_matches(index, key)) return false;
+        keys.remove_element_at(static_cast<int>(index));
+        values.remove_element_at(static_cast<int>(index));
         return true;
     }
-    // Remove a specified array element
-    // Returns false if removal was unsuccessful
-    bool remove_element(const T& target){
-        int targetIndex = -1;
-        for (int i = 0; i < size; i++){
-            if (array[i] == target) {
-                targetIndex = i;
-                break;
+    void clear(){
+        keys.clear();
+        values.clear();
+    }
+
+    // Pointer to key's value, or nullptr, like G_Dictionary::find.
+    V* find(const K& key){
+        size_t index = lower_bound(key);
+        return key_at_matches(index, key) ? values.array + index : nullptr;
+    }
+    const V* find(const K& key) const {
+        size_t index = lower_bound(key);
+        return key_at_matches(index, key) ? values.array + index : nullptr;
+    }
+    bool contains(const K& key) const {
+        return find(key) != nullptr;
+    }
+
+    // Ordered access. Entry i is the i-th smallest key and its value.
+    size_t lower_bound(const K& key) const {
+        return G_Sort::partition_point(keys.array, keys.array + keys.size,
+            [&](const K& k){ return comp(k, key); }) - keys.array;
+    }
+    size_t upper_bound(const K& key) const {
+        return G_Sort::partition_point(keys.array, keys.array + keys.size,
+            [&](const K& k){ return !comp(key, k); }) - keys.array;
+    }
+    // Indices [first, second) of the entries with low <= key <= high.
+    std::pair<size_t, size_t> range(const K& low, const K& high) const {
+        size_t first = lower_bound(low);
+        size_t last = upper_bound(high);
+        return std::make_pair(first, last < first ? first : last);
+    }
+    const K& key_at(size_t index) const {
+        return keys.array[index];
+    }
+    V& value_at(size_t index){
+        return values.array[index];
+    }
+    const V& value_at(size_t index) const {
+        return values.array[index];
+    }
+    size_t length() const {
+        return keys.size;
+    }
+};
+/*
+    G_ExternalSort sorts binary files of T that are too big to fit in memory.
+    The input is read in runs that fill the memory budget, each run is sorted
+    with G_Sort::sort (the same sort G_Array uses) and spilled to a temporary
+    file, then the runs are merged with a loser tree: each output element costs
+    one comparison per tree level. All file access goes through large
+    sequential buffers. At most MAX_FAN_IN runs are ever open: once that many
+    have been spilled, the smaller half is merged into one before the next
+    spill, and the final merge handles whatever is left.
+
+    T must be trivially copyable, since elements are written as raw bytes.
+*/
+template <typename T>
+class G_ExternalSort {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "G_ExternalSort writes elements as raw bytes");
+
+    // Most runs merged at once, and most spilled runs open at any time. Keeps
+    // each run's read buffer large and the file descriptors bounded.
+    static const size_t MAX_FAN_IN = 64;
+
+    // Timings and volumes of the last sort_file call.
+    struct Stats {
+        size_t elements = 0;
+        size_t runs = 0;
+        size_t mergePasses = 0;
+        double bytesSpilled = 0;   // run bytes written to temporary files
+        double bytesMerged = 0;    // bytes written by all merge passes
+        double spillSeconds = 0;   // reading, sorting and spilling the runs
+        double mergeSeconds = 0;
+    };
+
+    // memoryBytes is the budget for the run buffer, and later for the merge
+    // buffers.
+    G_ExternalSort(size_t memoryBytes = size_t(256) << 20) : memoryBytes(memoryBytes) {}
+
+    // Sorts the elements of the binary file inPath into outPath. comp is the
+    // same kind of functor G_Array::sort takes. Returns false, after printing
+    // why, if a file can't be opened, read or written, or if its size isn't a
+    // whole number of elements.
+    template <typename Compare>
+    bool sort_file(const std::string& inPath, const std::string& outPath, Compare comp){
+        Logger l = Logger("sort_file");
+        stats = Stats();
+        std::FILE* in = std::fopen(inPath.c_str(), "rb");
+        if (!in) {
+            std::cout << "Couldn't open " << inPath << " for reading.\n";
+            return false;
+        }
+
+        // Phase 1: sorted runs, spilled to temporary files. Whenever
+        // MAX_FAN_IN runs are open, the smaller half is merged into one, so
+        // the number of open files never grows past that.
+        auto spillStart = std::chrono::steady_clock::now();
+        double compactSeconds = 0;
+        size_t runCapacity = memoryBytes / sizeof(T) > 0 ? memoryBytes / sizeof(T) : 1;
+        T* run = new T[runCapacity];
+        std::FILE* runs[MAX_FAN_IN];
+        size_t runSizes[MAX_FAN_IN];
+        size_t runCount = 0;
+        bool ok = true;
+        size_t got;
+        while (ok && (got = std::fread(run, sizeof(T), runCapacity, in)) > 0){
+            if (runCount == MAX_FAN_IN) {
+                auto compactStart = std::chrono::steady_clock::now();
+                ok = compact_runs(runs, runSizes, runCount, comp);
+                compactSeconds += seconds_since(compactStart);
+                if (!ok) break;
+            }
+            G_Sort::sort(run, run + got, comp);
+            std::FILE* spill = std::tmpfile();
+            ok = spill && std::fwrite(run, sizeof(T), got, spill) == got;
+            if (ok) {
+                runs[runCount] = spill;
+                runSizes[runCount++] = got;
+                stats.runs++;
+                stats.elements += got;
+                stats.bytesSpilled += double(got) * sizeof(T);
             }
+            else if (spill) std::fclose(spill);
         }
-        if (targetIndex == -1) return false;
-        remove_element_at(targetIndex);
-        return true;
+        delete[] run;
+        if (ok && std::ferror(in)) {
+            std::cout << "Error reading " << inPath << ".\n";
+            ok = false;
+        }
+        // fread leaves a trailing partial element unreported; the read position
+        // gives it away. (Unknown for pipes, where ftell fails.)
+        long end = std::ftell(in);
+        if (ok && end >= 0 && uint64_t(end) != uint64_t(stats.elements) * sizeof(T)) {
+            std::cout << inPath << " is " << end << " bytes, not a multiple of the " << sizeof(T) << "-byte element.\n";
+            ok = false;
+        }
+        std::fclose(in);
+        stats.spillSeconds = seconds_since(spillStart) - compactSeconds;
+
+        // Phase 2: at most MAX_FAN_IN runs are left, so one merge straight to
+        // the output finishes the job.
+        auto mergeStart = std::chrono::steady_clock::now();
+        if (ok) {
+            std::FILE* out = std::fopen(outPath.c_str(), "wb");
+            ok = out != nullptr;
+            if (ok && runCount == 1) ok = copy_run(runs[0], out);
+            else if (ok && runCount > 1) {
+                ok = merge_runs(runs, runCount, out, comp);
+                stats.mergePasses++;
+            }
+            if (out && std::fclose(out) != 0) ok = false;
+        }
+        for (size_t i = 0; i < runCount; i++) std::fclose(runs[i]);
+        stats.mergeSeconds = seconds_since(mergeStart) + compactSeconds;
+
+        if (!ok) std::cout << "External sort of " << inPath << " into " << outPath << " failed.\n";
+        return ok;
     }
-    // Removes a specified index from array
-    // Returns false if index out of bounds
-    bool remove_element_at(int index){
-        Logger l = Logger("remove_element_at");
-        if (index < 0 || static_cast<size_t>(index) > size){
-            std::cout << "Attempted to remove index not within array.\n";
-            return false;
+
+    const Stats& get_stats() const { return stats; }
+
+    // Prints the spill and merge throughput of the last sort_file call.
+    void report(std::ostream& os = std::cout) const {
+        const double MB = 1024.0 * 1024.0;
+        os << std::fixed << std::setprecision(2);
+        os << "Sorted " << stats.elements << " elements in " << stats.runs << " runs.\n";
+        os << "Spill: " << stats.bytesSpilled / MB << " MB in " << stats.spillSeconds << " s ("
+           << (stats.spillSeconds > 0 ? stats.bytesSpilled / MB / stats.spillSeconds : 0) << " MB/s)\n";
+        os << "Merge: " << stats.mergePasses << " pass(es), " << stats.bytesMerged / MB << " MB in "
+           << stats.mergeSeconds << " s ("
+           << (stats.mergeSeconds > 0 ? stats.bytesMerged / MB / stats.mergeSeconds : 0) << " MB/s)\n";
+        os.unsetf(std::ios::fixed);
+    }
+
+private:
+    size_t memoryBytes;
+    Stats stats;
+
+    static double seconds_since(std::chrono::steady_clock::time_point start){
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // A buffered reader over one spilled run. A read error ends the run
+    // early and sets failed.
+    struct RunReader {
+        std::FILE* file;
+        T* buffer;
+        size_t capacity, count, position;
+        bool exhausted;
+        bool failed;
+
+        bool start(){
+            std::rewind(file);
+            return next_block();
         }
-        size--;
-        T* pTmp = new T[size];
-        for (size_t i = 0, j = 0; i < size + 1; i++) {
-            if (i != index) {
-                pTmp[j++] = array[i];
+        bool next_block(){
+            count = std::fread(buffer, sizeof(T), capacity, file);
+            position = 0;
+            if (count < capacity && std::ferror(file)) failed = true;
+            exhausted = count == 0;
+            return !exhausted;
+        }
+        const T& current() const { return buffer[position]; }
+        void advance(){
+            if (++position == count) next_block();
+        }
+    };
+
+    // Copies a whole spilled run to out.
+    bool copy_run(std::FILE* run, std::FILE* out){
+        size_t capacity = memoryBytes / sizeof(T) > 0 ? memoryBytes / sizeof(T) : 1;
+        T* buffer = new T[capacity];
+        std::rewind(run);
+        bool ok = true;
+        size_t got;
+        while (ok && (got = std::fread(buffer, sizeof(T), capacity, run)) > 0){
+            ok = std::fwrite(buffer, sizeof(T), got, out) == got;
+        }
+        if (std::ferror(run)) ok = false;
+        delete[] buffer;
+        return ok;
+    }
+
+    // Merges the smaller half of the open runs into one new run, leaving
+    // runCount at MAX_FAN_IN / 2 + 1. Merging the smallest first keeps each
+    // element's number of merges near log base MAX_FAN_IN / 2 of the run count.
+    template <typename Compare>
+    bool compact_runs(std::FILE** runs, size_t* runSizes, size_t& runCount, Compare comp){
+        // Largest first, so the runs to merge end up at the back.
+        for (size_t i = 1; i < runCount; i++){
+            for (size_t j = i; j > 0 && runSizes[j - 1] < runSizes[j]; j--){
+                std::swap(runSizes[j - 1], runSizes[j]);
+                std::swap(runs[j - 1], runs[j]);
             }
         }
-        delete[] array;
-        array = pTmp;
+        size_t keep = runCount - MAX_FAN_IN / 2;
+        std::FILE* merged = std::tmpfile();
+        bool ok = merged && merge_runs(runs + keep, runCount - keep, merged, comp);
+        size_t total = 0;
+        for (size_t i = keep; i < runCount; i++){
+            total += runSizes[i];
+            std::fclose(runs[i]);
+        }
+        stats.mergePasses++;
+        runCount = keep;
+        if (!ok) {
+            if (merged) std::fclose(merged);
+            return false;
+        }
+        runs[runCount] = merged;
+        runSizes[runCount++] = total;
         return true;
     }
-    // Overloading the [] operator to allow G_Array[idx] calls, rather
-    // than entire function calls written out. 
-    T& operator[](size_t index){
-        Logger l = Logger("[] operator");
-        if (index >= size){
-            std::cout << "Attempting to access an out of bounds indice.\n";
-            exit(0);
+
+    // k-way merge of runs into out through a loser tree. Node 0 holds the
+    // index of the current winner; nodes 1..k-1 hold the loser of the match
+    // played there. Ties go to the earlier run.
+    template <typename Compare>
+    bool merge_runs(std::FILE** files, size_t k, std::FILE* out, Compare comp){
+        // Split the memory between k input buffers and one output buffer.
+        size_t blockCapacity = memoryBytes / sizeof(T) / (k + 1);
+        if (blockCapacity < 1024) blockCapacity = 1024;
+        RunReader* readers = new RunReader[k];
+        T* storage = new T[blockCapacity * (k + 1)];
+        T* outBuffer = storage + blockCapacity * k;
+        for (size_t i = 0; i < k; i++){
+            readers[i] = RunReader{files[i], storage + blockCapacity * i, blockCapacity, 0, 0, true, false};
+            readers[i].start();
         }
-        else
-            return array[index];
+
+        // beats(a, b): run a's current element goes out before run b's.
+        // Index k is a sentinel that beats everything, used while building.
+        auto beats = [&](size_t a, size_t b){
+            if (a == k) return true;
+            if (b == k) return false;
+            if (readers[a].exhausted) return false;
+            if (readers[b].exhausted) return true;
+            if (comp(readers[a].current(), readers[b].current())) return true;
+            if (comp(readers[b].current(), readers[a].current())) return false;
+            return a < b;
+        };
+        size_t* tree = new size_t[k];
+        for (size_t i = 0; i < k; i++) tree[i] = k;
+        // Plays run s up from its leaf, leaving losers behind.
+        auto replay = [&](size_t s){
+            for (size_t node = (s + k) / 2; node > 0; node /= 2){
+                if (beats(tree[node], s)) std::swap(s, tree[node]);
+            }
+            tree[0] = s;
+        };
+        for (size_t s = k; s-- > 0;) replay(s);
+
+        bool ok = true;
+        size_t pending = 0;
+        while (ok && !readers[tree[0]].exhausted){
+            size_t winner = tree[0];
+            outBuffer[pending++] = readers[winner].current();
+            if (pending == blockCapacity) {
+                ok = std::fwrite(outBuffer, sizeof(T), pending, out) == pending;
+                stats.bytesMerged += double(pending) * sizeof(T);
+                pending = 0;
+            }
+            readers[winner].advance();
+            replay(winner);
+        }
+        if (ok && pending) {
+            ok = std::fwrite(outBuffer, sizeof(T), pending, out) == pending;
+            stats.bytesMerged += double(pending) * sizeof(T);
+        }
+        if (std::fflush(out) != 0) ok = false;
+        for (size_t i = 0; i < k; i++){
+            if (readers[i].failed) ok = false;
+        }
+
+        delete[] tree;
+        delete[] storage;
+        delete[] readers;
+        return ok;
     }
+};
 
-    size_t length(){
-        Logger l = Logger("length");
-        return size;
+/*
+    xoshiro256** by Blackman and Vigna: 256 bits of state, a period of 2^256 - 1,
+    and a few shifts, rotates and multiplies per 64-bit output. The state is
+    filled through SplitMix64, so any seed (0 included) gives a good state.
+    It meets the UniformRandomBitGenerator requirements, so <random>
+    distributions and std::shuffle accept it.
+*/
+class G_Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    explicit G_Xoshiro256(uint64_t seed = 0x9E3779B97F4A7C15ull){
+        this->seed(seed);
+    }
+    void seed(uint64_t value){
+        for (int i = 0; i < 4; i++) state[i] = splitmix64(value);
     }
 
-    void display(){
-        for (int i = 0; i < size; i++){
-            std::cout << array[i] << ' ';
-        }
+    uint64_t operator()(){
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
     }
 
-    // Sort function using a functor for comparison
-    // Time complexity O(n^2)? Not great...
-    template <typename Compare>
-    void sort(Compare comp) {
-        if (size > 1) {
-            for (size_t i = 0; i < size - 1; i++) {
-                for (size_t j = 0; j < size - i - 1; j++) {
-                    if (!comp(array[j], array[j + 1])) {
-                        swap(array[j], array[j + 1]);
-                    }
+    // Advances the generator by 2^128 draws. Jumping a copy k times gives k
+    // streams that can never overlap.
+    void jump(){
+        static const uint64_t JUMP[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                        0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+        uint64_t next[4] = {0, 0, 0, 0};
+        for (uint64_t word : JUMP){
+            for (int bit = 0; bit < 64; bit++){
+                if (word & (uint64_t(1) << bit)){
+                    for (int i = 0; i < 4; i++) next[i] ^= state[i];
                 }
+                (*this)();
             }
         }
+        for (int i = 0; i < 4; i++) state[i] = next[i];
     }
 
-    void ComponentTest(){
-        std::cout << "Beginning Component testing of G_Array class template.\n";
-        std::cout << "Length: " << length() << '\n';
-        std::cout << "Adding element.\n";
-        add_element(T());
-        std::cout << "Length: " << length() << '\n';
-        std::cout << "Removing element.\n";
-        remove_element();
-        std::cout << "Length: " << length() << '\n';
-        std::cout << "Completed component test of G_Array\n\n";
+    // Steps x and returns a well-mixed 64-bit value.
+    static uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
     }
-};
 
+    static constexpr uint64_t min(){ return 0; }
+    static constexpr uint64_t max(){ return UINT64_MAX; }
 
+private:
+    static uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+    uint64_t state[4];
+};
 
 /*
-    The following three functors define three sorting methods-- ascending, descending,
-    and absolute ascending. Ascending sorts from least to greatest, descending from 
-    greatest to least. Absolute Ascending sorts from least to greatest, but considers
-    the absolute values of the inputs, not the true values. AKA it sorts by 
-    "intensity"
+    Eight xoshiro256** streams stored lane by lane and stepped together, so a
+    step is a handful of vector shifts, adds and xors (the * 5 and * 9 are
+    shifts and adds). RandNo's fill_ints and fill_floats draw from it. Uses AVX2
+    when the CPU has it, the same check G_Simd makes, and a plain lane loop
+    otherwise.
 */
-template <typename T>
-struct Ascending{
-    // Overloading () to make this struct a functor
-    bool operator()(T a, T b) const {
-        return a > b; // For descending order, essentially returning true IF a is greater than b
+class G_XoshiroLanes {
+public:
+    static constexpr size_t LANES = 8;
+
+    // Seeds every lane from source's output. With a period of 2^256 the lanes
+    // will not overlap in practice.
+    void seed(G_Xoshiro256& source){
+        for (size_t w = 0; w < 4; w++){
+            for (size_t l = 0; l < LANES; l++) state[w][l] = source();
+        }
     }
-};
 
-template <typename T>
-struct Descending{
-    // Overloading () to make this struct a functor
-    bool operator()(T a, T b) const {
-        return b > a; // For ascending, true IF b greater than a
+    // Writes count outputs, which must be a multiple of LANES.
+    void fill(uint64_t* out, size_t count){
+#ifdef G_SIMD_X86
+        if (G_Simd::has_avx2()) return avx2_fill(out, count);
+#endif
+        scalar_fill(out, count);
+    }
+
+private:
+    uint64_t state[4][LANES];
+
+    void scalar_fill(uint64_t* out, size_t count){
+        for (size_t i = 0; i < count; i += LANES){
+            for (size_t l = 0; l < LANES; l++){
+                uint64_t s1 = state[1][l];
+                uint64_t x = s1 + (s1 << 2);
+                x = (x << 7) | (x >> 57);
+                out[i + l] = x + (x << 3);
+                uint64_t t = s1 << 17;
+                state[2][l] ^= state[0][l];
+                state[3][l] ^= s1;
+                state[1][l] = s1 ^ state[2][l];
+                state[0][l] ^= state[3][l];
+                state[2][l] ^= t;
+                state[3][l] = (state[3][l] << 45) | (state[3][l] >> 19);
+            }
+        }
+    }
+#ifdef G_SIMD_X86
+    __attribute__((target("avx2")))
+    void avx2_fill(uint64_t* out, size_t count){
+        __m256i s[4][2];
+        for (int w = 0; w < 4; w++){
+            for (int h = 0; h < 2; h++) s[w][h] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&state[w][h * 4]));
+        }
+        for (size_t i = 0; i < count; i += LANES){
+            for (int h = 0; h < 2; h++){
+                __m256i s1 = s[1][h];
+                __m256i x = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+                x = _mm256_or_si256(_mm256_slli_epi64(x, 7), _mm256_srli_epi64(x, 57));
+                x = _mm256_add_epi64(x, _mm256_slli_epi64(x, 3));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + h * 4), x);
+                __m256i t = _mm256_slli_epi64(s1, 17);
+                s[2][h] = _mm256_xor_si256(s[2][h], s[0][h]);
+                s[3][h] = _mm256_xor_si256(s[3][h], s1);
+                s[1][h] = _mm256_xor_si256(s1, s[2][h]);
+                s[0][h] = _mm256_xor_si256(s[0][h], s[3][h]);
+                s[2][h] = _mm256_xor_si256(s[2][h], t);
+                s[3][h] = _mm256_or_si256(_mm256_slli_epi64(s[3][h], 45), _mm256_srli_epi64(s[3][h], 19));
+            }
+        }
+        for (int w = 0; w < 4; w++){
+            for (int h = 0; h < 2; h++) _mm256_storeu_si256(reinterpret_cast<__m256i*>(&state[w][h * 4]), s[w][h]);
+        }
     }
+#endif
 };
 
-template <typename T>
-struct AbsoluteValueComparison{
-    // overloading () to make this a functor
-    bool operator()(T a, T b) const {
-        return std::abs(a) < std::abs(b); // return true IF abs(a) greater than abs(b)
+/*
+    Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+    3"): a keyed bijection from a 128-bit counter to 128 random bits. Nothing
+    is carried from one output to the next, so any output of any stream can be
+    computed directly from its key and position, in any order and on any thread.
+*/
+class G_Philox {
+public:
+    // Ten rounds of multiply, swap and xor over counter, with the key bumped
+    // between rounds.
+    static void block(const uint32_t counter[4], uint64_t key, uint32_t out[4]){
+        uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+        uint32_t k0 = uint32_t(key), k1 = uint32_t(key >> 32);
+        for (int round = 0; round < 10; round++){
+            if (round) {
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+            uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+            uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+            c1 = uint32_t(p1);
+            c3 = uint32_t(p0);
+            c0 = n0;
+            c2 = n2;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
     }
 };
+
 /*
     A singleton random number generator that provides multiple methods for creating
     randomness
+    October 19: Backed by G_Xoshiro256 instead of std::rand, which has a small
+    period and takes a libc lock on every call. Every thread gets its own engine,
+    seeded from the shared seed mixed with the thread's ordinal, so threads
+    never share state, and with a 2^256 period their streams won't meet in
+    practice. Setting a seed with >> reseeds every thread on its next draw. The draw methods no longer log: they run in tight loops and on
+    several threads, and Logger is neither cheap nor thread safe.
+    October 19: random_int maps a draw onto the range with Lemire's
+    multiply-shift method instead of %, which was biased towards low values
+    and cost a division. random_float scales 24 random bits, so each of 2^24
+    evenly spaced values is equally likely. fill_ints and fill_floats produce
+    whole buffers at once from G_XoshiroLanes.
+    October 19: stream({...}) returns a Stream that depends only on the values
+    it was keyed with, e.g. {seed, generation, robot, map}. It ignores the
+    shared seed, the calling thread and anything drawn before, so a parallel
+    run gives the same numbers at any thread count and one entity's draws can
+    be replayed on their own.
 */
 class RandNo {
 public:
@@ -232,34 +3249,278 @@ public:
     friend std::istream& operator>>(std::istream& is, RandNo& rng) {
         int seed;
         is >> seed;
-        std::srand(static_cast<unsigned int>(seed));
+        rng.reseed(static_cast<uint64_t>(seed));
         return is;
     }
 
-    // Static method to access the singleton instance
-    // Once RandNo is made, its static nature keeps it present
-    // in only one place.
-    static RandNo& get_instance() {
-        Logger l = Logger("get_instance");
-        static RandNo instance;
-        return instance;
+    // Static method to access the singleton instance
+    // Once RandNo is made, its static nature keeps it present
+    // in only one place.
+    static RandNo& get_instance() {
+        static RandNo instance;
+        return instance;
+    }
+
+    // Sets the seed for every thread. A thread's sequence depends on the seed
+    // and on how many threads first drew a number before it did.
+    void reseed(uint64_t seed){
+        baseSeed.store(seed, std::memory_order_relaxed);
+        epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    // Method to generate a random integer between min and max
+    int random_int(int min, int max) {
+        return int(min + int64_t(bounded(engine(), span_of(min, max))));
+    }
+    // Method to generate a random floating point value between min and max
+    float random_float(float min, float max) {
+        return min + unit_float(uint32_t(engine()() >> 32)) * (max - min);
+    }
+
+    // Fills out[0..count) with integers between min and max, as random_int
+    // would but many at a time. Costs one division per call rather than per
+    // value.
+    void fill_ints(int* out, size_t count, int min, int max){
+        uint64_t range = span_of(min, max);
+        // Products whose low half falls below this are the biased ones.
+        uint32_t threshold = uint32_t((uint64_t(1) << 32) % range);
+        ThreadState& local = thread_state();
+        uint32_t words[BATCH_WORDS];
+        while (count){
+            size_t n = std::min(count, BATCH_WORDS);
+            next_words(local, words, n);
+            bool rejected = false;
+            for (size_t i = 0; i < n; i++){
+                uint64_t product = uint64_t(words[i]) * range;
+                out[i] = int(min + int64_t(product >> 32));
+                rejected |= uint32_t(product) < threshold;
+            }
+            // Rare: redraw the biased ones one at a time.
+            if (rejected){
+                for (size_t i = 0; i < n; i++){
+                    if (uint32_t(uint64_t(words[i]) * range) < threshold) out[i] = int(min + int64_t(bounded(local.engine, range)));
+                }
+            }
+            out += n;
+            count -= n;
+        }
+    }
+    // Fills out[0..count) with floats between min and max, as random_float
+    // would.
+    void fill_floats(float* out, size_t count, float min, float max){
+        ThreadState& local = thread_state();
+        float width = max - min;
+        uint32_t words[BATCH_WORDS];
+        while (count){
+            size_t n = std::min(count, BATCH_WORDS);
+            next_words(local, words, n);
+            for (size_t i = 0; i < n; i++) out[i] = min + unit_float(words[i]) * width;
+            out += n;
+            count -= n;
+        }
+    }
+    // Raw 64 random bits from this thread's engine.
+    uint64_t next_u64() {
+        return engine()();
+    }
+
+    /*
+        A counter-based stream: output n is G_Philox applied to (stream id, n)
+        under the stream's key, so streams are independent, cheap to create,
+        and can seek to any position.
+    */
+    class Stream {
+    public:
+        typedef uint64_t result_type;
+
+        Stream(uint64_t key, uint64_t id) : key(key), id(id), blockIndex(0), used(4) {}
+
+        int random_int(int min, int max){
+            return int(min + int64_t(bounded(*this, span_of(min, max))));
+        }
+        float random_float(float min, float max){
+            return min + unit_float(next_u32()) * (max - min);
+        }
+        uint32_t next_u32(){
+            if (used == 4) {
+                refill(blockIndex++);
+                used = 0;
+            }
+            return buffer[used++];
+        }
+        uint64_t operator()(){
+            uint64_t high = next_u32();
+            return (high << 32) | next_u32();
+        }
+
+        // Number of 32-bit words drawn so far.
+        uint64_t position() const {
+            return blockIndex * 4 - (4 - used);
+        }
+        // Moves to the given word position, as if that many had been drawn.
+        void seek(uint64_t words){
+            blockIndex = words / 4;
+            used = 4;
+            if (words % 4) {
+                refill(blockIndex++);
+                used = unsigned(words % 4);
+            }
+        }
+
+        static constexpr uint64_t min(){ return 0; }
+        static constexpr uint64_t max(){ return UINT64_MAX; }
+
+    private:
+        uint64_t key;
+        uint64_t id;
+        uint64_t blockIndex;
+        unsigned used;
+        uint32_t buffer[4];
+
+        void refill(uint64_t index){
+            uint32_t counter[4] = {uint32_t(index), uint32_t(index >> 32), uint32_t(id), uint32_t(id >> 32)};
+            G_Philox::block(counter, key, buffer);
+        }
+    };
+
+    // The stream for a tuple of keys. Equal tuples give equal streams; tuples
+    // that differ in any value, or in length, give unrelated ones.
+    static Stream stream(std::initializer_list<uint64_t> keys){
+        uint64_t state = 0x243F6A8885A308D3ull ^ keys.size();
+        for (uint64_t value : keys){
+            state ^= value;
+            G_Xoshiro256::splitmix64(state);
+            state = G_Xoshiro256::splitmix64(state);
+        }
+        uint64_t key = G_Xoshiro256::splitmix64(state);
+        return Stream(key, G_Xoshiro256::splitmix64(state));
+    }
+
+    // Compares draws per second with the std::rand version, on one thread and
+    // on several at once.
+    static void Benchmark(size_t draws = 1 << 24){
+        RandNo& rng = get_instance();
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Beginning RandNo benchmark (" << draws << " draws per thread, "
+                  << hardware << " hardware threads).\n";
+        unsigned counts[] = {1, 2, 4, hardware};
+        for (size_t c = 0; c < 4; c++){
+            unsigned threads = counts[c];
+            if (c == 3 && threads <= 4) break;
+            double rates[2];
+            for (int useEngine = 0; useEngine < 2; useEngine++){
+                std::atomic<int64_t> sink{0};
+                std::thread* workers = new std::thread[threads];
+                auto begin = std::chrono::steady_clock::now();
+                for (unsigned t = 0; t < threads; t++){
+                    workers[t] = std::thread([&rng, &sink, draws, useEngine]{
+                        int64_t sum = 0;
+                        if (useEngine) for (size_t i = 0; i < draws; i++) sum += rng.random_int(0, 100);
+                        else for (size_t i = 0; i < draws; i++) sum += std::rand() % 101;
+                        sink += sum;
+                    });
+                }
+                for (unsigned t = 0; t < threads; t++) workers[t].join();
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                delete[] workers;
+                rates[useEngine] = double(threads) * draws / seconds / 1e6;
+            }
+            std::cout << std::setw(4) << threads << " thread(s): " << std::fixed << std::setprecision(1)
+                      << "std::rand " << rates[0] << " M/s, xoshiro256** " << rates[1] << " M/s ("
+                      << std::setprecision(2) << rates[1] / rates[0] << "x).\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+
+        size_t count = draws;
+        int* ints = new int[count];
+        float* floats = new float[count];
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) ints[i] = rng.random_int(0, 100);
+        double single = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        begin = std::chrono::steady_clock::now();
+        rng.fill_ints(ints, count, 0, 100);
+        double batch = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        begin = std::chrono::steady_clock::now();
+        rng.fill_floats(floats, count, 0.0f, 1.0f);
+        double batchFloats = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << std::fixed << std::setprecision(1) << "random_int loop " << count / single / 1e6
+                  << " M/s, fill_ints " << count / batch / 1e6 << " M/s, fill_floats "
+                  << count / batchFloats / 1e6 << " M/s" << (G_Simd::has_avx2() ? " (AVX2)" : "") << ".\n";
+        std::cout.unsetf(std::ios::fixed);
+        delete[] ints;
+        delete[] floats;
     }
 
-    // Method to generate a random integer between min and max
-    int random_int(int min, int max) {
-        Logger l = Logger("random_int");
-        return min + rand() % (max - min + 1);
+private:
+    // 32-bit draws produced per refill of a fill_ints or fill_floats buffer.
+    static constexpr size_t BATCH_WORDS = 512;
+
+    struct ThreadState {
+        G_Xoshiro256 engine;
+        G_XoshiroLanes lanes;
+        uint64_t epoch = 0;
+        uint64_t lanesEpoch = 0;
+        uint64_t ordinal = nextOrdinal.fetch_add(1, std::memory_order_relaxed);
+    };
+    inline static std::atomic<uint64_t> baseSeed{0};
+    // Bumped on every reseed; a thread whose copy is stale reseeds itself.
+    inline static std::atomic<uint64_t> epoch{0};
+    inline static std::atomic<uint64_t> nextOrdinal{0};
+
+    static ThreadState& thread_state(){
+        thread_local ThreadState local;
+        uint64_t current = epoch.load(std::memory_order_acquire);
+        if (local.epoch != current) {
+            // Mixing the ordinal into the seed costs the same for every
+            // thread, however many came before it.
+            uint64_t ordinal = local.ordinal;
+            local.engine.seed(baseSeed.load(std::memory_order_relaxed) ^ G_Xoshiro256::splitmix64(ordinal));
+            local.epoch = current;
+        }
+        return local;
     }
-    // Method to generate a random floating point value between min and max
-    float random_float(float min, float max) {
-        Logger l = Logger("random_float");
-        return min + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+    static G_Xoshiro256& engine(){
+        return thread_state().engine;
     }
-private:
+    // Fills words[0..n) from the thread's lanes, seeding them from its engine
+    // the first time after a reseed. n must be at most BATCH_WORDS.
+    static void next_words(ThreadState& local, uint32_t* words, size_t n){
+        if (local.lanesEpoch != local.epoch) {
+            local.lanes.seed(local.engine);
+            local.lanesEpoch = local.epoch;
+        }
+        uint64_t raw[BATCH_WORDS / 2];
+        size_t rawCount = ((n + 1) / 2 + G_XoshiroLanes::LANES - 1) / G_XoshiroLanes::LANES * G_XoshiroLanes::LANES;
+        local.lanes.fill(raw, rawCount);
+        std::memcpy(words, raw, n * sizeof(uint32_t));
+    }
+
+    // Number of values between min and max inclusive, 1 to 2^32.
+    static uint64_t span_of(int min, int max){
+        return uint64_t(int64_t(max) - min) + 1;
+    }
+    // Lemire's method: a uniform value below range from the top of a 32x32 bit
+    // product, redrawing only when the low half lands in the short biased
+    // stretch. The division that finds that stretch runs only on the rare
+    // draws that might be in it.
+    template <typename Source>
+    static uint64_t bounded(Source& source, uint64_t range){
+        uint64_t product = (source() >> 32) * range;
+        if (uint32_t(product) < range) {
+            uint32_t threshold = uint32_t((uint64_t(1) << 32) % range);
+            while (uint32_t(product) < threshold) product = (source() >> 32) * range;
+        }
+        return product >> 32;
+    }
+    // 24 random bits scaled into [0, 1); every result is an exact float.
+    static float unit_float(uint32_t bits){
+        return float(int32_t(bits >> 8)) * (1.0f / 16777216.0f);
+    }
+
     // Private constructor to prevent instantiation
     RandNo() {
         Logger l = Logger("RandNo Constructor");
-        std::srand(static_cast<unsigned int>(std::time(0))); // Seed the random number generator
+        reseed(static_cast<uint64_t>(std::time(0))); // Seed the random number generator
     }
 };
 /*
@@ -348,91 +3609,1362 @@ public:
     }
 };
 /*
-    A static class that prints colored text.
+    A static class that prints colored text.
+*/
+class FancyText {
+private:
+    static inline std::string RED = "\e[31m";
+    static inline std::string GREEN = "\e[32m";
+    static inline std::string YELLOW = "\e[33m";
+    static inline std::string NORMAL = "\e[0m";
+public:
+    /*
+        Print the given text in a color provided by FancyText. Use the color's
+        name's first character to select a color. If a newline is needed after
+        what is being printed, pass a boolean true as the third parameter.
+        Newline defaults to false, color defaults to white.
+    */
+    static void print_colored(std::string text, char col = '\0', bool newline = false){
+        Logger l = Logger("print_colored");
+        std::string color;
+        if (col == 'r') color = RED;
+        else if (col == 'y') color = YELLOW;
+        else if (col == 'g') color = GREEN;
+        else color = NORMAL;
+        std::cout << color << text << NORMAL << newline ? '\n' : '\0';
+    }
+};
+
+/*
+    Transparent hash and equality for string keys. std::string, std::string_view
+    and const char* all hash to the same value, so a table can be searched
+    with a literal or a substring without building a std::string first.
+*/
+struct G_StringHash {
+    typedef void is_transparent;
+    size_t operator()(std::string_view key) const {
+        return std::hash<std::string_view>()(key);
+    }
+};
+struct G_StringEqual {
+    typedef void is_transparent;
+    bool operator()(std::string_view a, std::string_view b) const {
+        return a == b;
+    }
+};
+
+/*
+    A handle to a string in a G_StringPool. Two handles from the same pool are
+    equal exactly when their strings are, so comparing or hashing them is an
+    integer operation. Ordering is by handle (roughly first-interned first),
+    not alphabetical, which is all a sorted container like G_FlatMap needs.
+*/
+struct G_Symbol {
+    uint32_t id;
+
+    G_Symbol() : id(0) {}
+    explicit G_Symbol(uint32_t id) : id(id) {}
+    bool operator==(G_Symbol other) const { return id == other.id; }
+    bool operator!=(G_Symbol other) const { return id != other.id; }
+    bool operator<(G_Symbol other) const { return id < other.id; }
+    bool operator>(G_Symbol other) const { return id > other.id; }
+};
+struct G_SymbolHash {
+    size_t operator()(G_Symbol symbol) const {
+        return symbol.id * size_t(0x9E3779B97F4A7C15ull);
+    }
+};
+
+/*
+    G_StringPool interns strings: each distinct string is stored once, in
+    large arena blocks, and named by a 32-bit G_Symbol. Interning hashes the
+    text and checks a small open-addressing index of handles, so a repeated
+    string costs one hash and (usually) one compare and no allocation.
+    Stored strings never move, and the views and c_str() pointers the pool
+    hands out stay valid for the pool's lifetime.
+
+    Handle 0 is always the empty string, so a default G_Symbol is valid.
+    Not thread-safe; give each thread its own pool or guard it.
+*/
+class G_StringPool {
+public:
+    G_StringPool() : entries(nullptr), entryCount(0), entryCapacity(0), blocks(nullptr), blockCount(0),
+                     blockCapacity(0), currentBlock(nullptr), blockUsed(BLOCK_SIZE),
+                     index(nullptr), indexCapacity(0), arenaBytes(0) {
+        intern(std::string_view());
+    }
+    G_StringPool(const G_StringPool&) = delete;
+    G_StringPool& operator=(const G_StringPool&) = delete;
+    ~G_StringPool(){
+        for (size_t i = 0; i < blockCount; i++) G_HeapAllocator::deallocate(blocks[i], 0);
+        if (blocks) G_HeapAllocator::deallocate(blocks, blockCapacity * sizeof(char*));
+        if (entries) G_HeapAllocator::deallocate(entries, entryCapacity * sizeof(Entry));
+        if (index) G_HeapAllocator::deallocate(index, indexCapacity * sizeof(uint32_t));
+    }
+
+    // A pool shared by the whole program, for code that has no better owner.
+    static G_StringPool& global(){
+        static G_StringPool pool;
+        return pool;
+    }
+
+    // Returns text's handle, storing text first if the pool hasn't seen it.
+    G_Symbol intern(std::string_view text){
+        uint32_t hash = hash_text(text);
+        size_t slot = find_slot(text, hash);
+        if (index && index[slot] != EMPTY) return G_Symbol(index[slot]);
+        if ((entryCount + 1) * 2 > indexCapacity) {
+            grow_index();
+            slot = find_slot(text, hash);
+        }
+        Entry entry;
+        entry.text = store(text);
+        entry.length = static_cast<uint32_t>(text.size());
+        entry.hash = hash;
+        if (entryCount == entryCapacity) grow(entries, entryCapacity);
+        uint32_t id = entryCount++;
+        entries[id] = entry;
+        index[slot] = id;
+        return G_Symbol(id);
+    }
+    // Looks text up without adding it. Returns false if it was never interned.
+    bool lookup(std::string_view text, G_Symbol& out) const {
+        if (!index) return false;
+        size_t slot = find_slot(text, hash_text(text));
+        if (index[slot] == EMPTY) return false;
+        out = G_Symbol(index[slot]);
+        return true;
+    }
+
+    std::string_view view(G_Symbol symbol) const {
+        const Entry& entry = entries[symbol.id];
+        return std::string_view(entry.text, entry.length);
+    }
+    // Stored strings are null-terminated.
+    const char* c_str(G_Symbol symbol) const {
+        return entries[symbol.id].text;
+    }
+    // Distinct strings held, counting the empty string.
+    size_t size() const {
+        return entryCount;
+    }
+    // Bytes of text stored, including terminators.
+    size_t bytes_used() const {
+        return arenaBytes;
+    }
+
+private:
+    struct Entry {
+        const char* text;
+        uint32_t length;
+        uint32_t hash;
+    };
+    static const size_t BLOCK_SIZE = 64 * 1024;
+    static const uint32_t EMPTY = UINT32_MAX;
+
+    // Plain buffers rather than G_Array, whose add_element logs; interning is
+    // meant to be cheap enough for hot paths.
+    Entry* entries;
+    uint32_t entryCount;
+    size_t entryCapacity;
+    char** blocks;
+    size_t blockCount;
+    size_t blockCapacity;
+    char* currentBlock;
+    size_t blockUsed;
+    // Open-addressing index of handles, kept at most half full.
+    uint32_t* index;
+    size_t indexCapacity;
+    size_t arenaBytes;
+
+    static uint32_t hash_text(std::string_view text){
+        return static_cast<uint32_t>(G_StringHash()(text));
+    }
+    // Slot holding text's handle, or the empty slot where it would go.
+    size_t find_slot(std::string_view text, uint32_t hash) const {
+        if (!index) return 0;
+        size_t mask = indexCapacity - 1;
+        for (size_t slot = hash & mask; ; slot = (slot + 1) & mask){
+            uint32_t id = index[slot];
+            if (id == EMPTY) return slot;
+            const Entry& entry = entries[id];
+            if (entry.hash == hash && std::string_view(entry.text, entry.length) == text) return slot;
+        }
+    }
+    void grow_index(){
+        size_t newCapacity = indexCapacity ? indexCapacity * 2 : 64;
+        uint32_t* newIndex = static_cast<uint32_t*>(G_HeapAllocator::allocate(newCapacity * sizeof(uint32_t)));
+        for (size_t i = 0; i < newCapacity; i++) newIndex[i] = EMPTY;
+        for (size_t i = 0; i < indexCapacity; i++){
+            uint32_t id = index[i];
+            if (id == EMPTY) continue;
+            size_t slot = entries[id].hash & (newCapacity - 1);
+            while (newIndex[slot] != EMPTY) slot = (slot + 1) & (newCapacity - 1);
+            newIndex[slot] = id;
+        }
+        if (index) G_HeapAllocator::deallocate(index, indexCapacity * sizeof(uint32_t));
+        index = newIndex;
+        indexCapacity = newCapacity;
+    }
+    void add_block(char* block){
+        if (blockCount == blockCapacity) grow(blocks, blockCapacity);
+        blocks[blockCount++] = block;
+    }
+    // Doubles a buffer of trivially copyable T, as grow_index does for the
+    // index.
+    template <typename T>
+    static void grow(T*& buffer, size_t& capacity){
+        size_t newCapacity = capacity ? capacity * 2 : 64;
+        T* grown = static_cast<T*>(G_HeapAllocator::allocate(newCapacity * sizeof(T)));
+        if (buffer) {
+            std::memcpy(grown, buffer, capacity * sizeof(T));
+            G_HeapAllocator::deallocate(buffer, capacity * sizeof(T));
+        }
+        buffer = grown;
+        capacity = newCapacity;
+    }
+    // Copies text into the arena with a terminator. Strings too big for a
+    // block get a block of their own.
+    const char* store(std::string_view text){
+        size_t bytes = text.size() + 1;
+        char* out;
+        if (bytes > BLOCK_SIZE / 4) {
+            out = static_cast<char*>(G_HeapAllocator::allocate(bytes));
+            add_block(out);
+        }
+        else {
+            if (blockUsed + bytes > BLOCK_SIZE) {
+                currentBlock = static_cast<char*>(G_HeapAllocator::allocate(BLOCK_SIZE));
+                add_block(currentBlock);
+                blockUsed = 0;
+            }
+            out = currentBlock + blockUsed;
+            blockUsed += bytes;
+        }
+        // The empty string's data() may be null, which memcpy doesn't allow.
+        if (!text.empty()) std::memcpy(out, text.data(), text.size());
+        out[text.size()] = '\0';
+        arenaBytes += bytes;
+        return out;
+    }
+};
+
+/*
+    G_PerfectHash is a keyword table built entirely at compile time. The
+    constructor searches for a hash seed under which every keyword lands in
+    its own slot, so find() costs one hash and one string compare and returns
+    the keyword's position in the list (or -1). That position can index an
+    array of handlers or be switched on directly:
+
+        static constexpr std::string_view COMMANDS[] = {"PLAY", "FEED", "QUIT"};
+        static constexpr G_PerfectHash commandTable(COMMANDS);
+        switch (commandTable.find(command)) { ... }
+
+    The table has at least four slots per keyword, which keeps the seed
+    search short for lists of up to a few dozen words. If no seed works the
+    constructor throws, which fails the build rather than the program.
+*/
+template <size_t N>
+class G_PerfectHash {
+public:
+    // The smallest power of two with at least four slots per keyword.
+    static constexpr size_t SLOTS = []{
+        size_t size = 8;
+        while (size < 4 * N) size *= 2;
+        return size;
+    }();
+
+    constexpr G_PerfectHash(const std::string_view (&keywords)[N]){
+        for (size_t i = 0; i < N; i++) words[i] = keywords[i];
+        for (uint32_t candidate = 0; candidate < MAX_SEED; candidate++){
+            if (try_seed(candidate)) {
+                seed = candidate;
+                return;
+            }
+        }
+        throw "G_PerfectHash: no collision-free seed for these keywords";
+    }
+
+    // Position of word in the keyword list, or -1 if it isn't one.
+    constexpr int find(std::string_view word) const {
+        int index = slots[hash(seed, word) & (SLOTS - 1)];
+        return index >= 0 && words[index] == word ? index : -1;
+    }
+    constexpr bool contains(std::string_view word) const {
+        return find(word) != -1;
+    }
+    constexpr std::string_view keyword(size_t index) const {
+        return words[index];
+    }
+    constexpr size_t size() const {
+        return N;
+    }
+
+private:
+    static const uint32_t MAX_SEED = 1 << 16;
+
+    std::string_view words[N] = {};
+    int slots[SLOTS] = {};
+    uint32_t seed = 0;
+
+    // Seeded FNV-1a with a final mix so the low bits depend on every byte.
+    static constexpr uint32_t hash(uint32_t seed, std::string_view word){
+        uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (char c : word) h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        return h;
+    }
+    constexpr bool try_seed(uint32_t candidate){
+        for (size_t i = 0; i < SLOTS; i++) slots[i] = -1;
+        for (size_t i = 0; i < N; i++){
+            int& slot = slots[hash(candidate, words[i]) & (SLOTS - 1)];
+            if (slot != -1) return false;
+            slot = static_cast<int>(i);
+        }
+        return true;
+    }
+};
+
+/*
+    A basic implementation of a dictionary that supports key-value pairs between
+    a string (always) and another type. The second type is templated.
+    I may eventually support non-string keys, but I don't want to implement that yet.
+    (Until then, G_FlatMap takes any key type that can be ordered.)
+
+    October 19: The parallel key/value arrays (a linear scan per lookup) are
+    replaced with an open-addressing hash table in the SwissTable style. Each
+    slot has a control byte holding 7 bits of the key's hash, or a marker for
+    an empty or deleted slot. A lookup hashes the key once, then checks the
+    control bytes of 16 slots at a time (one SSE2 compare on x86), and only
+    compares strings whose hash bits already match. Lookup, insert and erase
+    are O(1) on average. add_pair on an existing key now replaces its value.
+    October 19: Lookups take std::string_view (hashed with G_StringHash), so
+    searching with a literal or a substring doesn't allocate. Only inserting a
+    new key copies it into a std::string.
+    October 19: Added clear, save_snapshot and load_snapshot.
+*/
+template <typename T, typename Allocator = G_HeapAllocator>
+class G_Dictionary {
+private:
+    struct Slot {
+        std::string key;
+        T value;
+    };
+    static const size_t GROUP_WIDTH = 16;
+    static const size_t MIN_CAPACITY = 16;
+    static const signed char EMPTY = -128;
+    static const signed char DELETED = -2;
+
+    // Slots are probed in aligned groups of GROUP_WIDTH. A probe stops at the
+    // first group with an empty slot, so a full group never ends a search.
+    signed char* control;
+    Slot* slots;
+    size_t capacity;
+    size_t count;
+    // Inserts into empty slots left before the table has to grow. Deleted
+    // slots still count against it until the next rehash clears them.
+    size_t growthLeft;
+    float maxLoad;
+
+    static size_t hash_key(std::string_view key){
+        return G_StringHash()(key);
+    }
+    // The low 7 bits go into the control byte; the rest pick the group.
+    static signed char hash_tag(size_t hash){
+        return static_cast<signed char>(hash & 0x7F);
+    }
+    size_t first_group(size_t hash) const {
+        return (hash >> 7) & (capacity / GROUP_WIDTH - 1);
+    }
+
+    static unsigned lowest_bit(unsigned mask){
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctz(mask);
+#else
+        unsigned bit = 0;
+        while (!(mask & 1)) { mask >>= 1; bit++; }
+        return bit;
+#endif
+    }
+    // Bit i is set if slot i of the group has control byte tag.
+    static unsigned match(const signed char* group, signed char tag){
+#ifdef G_SIMD_X86
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+        unsigned mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= unsigned(group[i] == tag) << i;
+        return mask;
+#endif
+    }
+    // Bit i is set if slot i is empty or deleted: both markers are negative.
+    static unsigned match_free(const signed char* group){
+#ifdef G_SIMD_X86
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        unsigned mask = 0;
+        for (size_t i = 0; i < GROUP_WIDTH; i++) mask |= unsigned(group[i] < 0) << i;
+        return mask;
+#endif
+    }
+
+    // Index of key's slot, or capacity if the key isn't present.
+    size_t find_slot(std::string_view key, size_t hash) const {
+        if (count == 0) return capacity;
+        size_t groups = capacity / GROUP_WIDTH;
+        size_t group = first_group(hash);
+        signed char tag = hash_tag(hash);
+        // Triangular steps visit every group once when the group count is a
+        // power of two.
+        for (size_t step = 1; step <= groups; step++){
+            const signed char* ctrl = control + group * GROUP_WIDTH;
+            for (unsigned mask = match(ctrl, tag); mask; mask &= mask - 1){
+                size_t index = group * GROUP_WIDTH + lowest_bit(mask);
+                if (G_StringEqual()(slots[index].key, key)) return index;
+            }
+            if (match(ctrl, EMPTY)) return capacity;
+            group = (group + step) & (groups - 1);
+        }
+        return capacity;
+    }
+    // First empty or deleted slot on hash's probe sequence.
+    size_t free_slot(size_t hash) const {
+        size_t groups = capacity / GROUP_WIDTH;
+        size_t group = first_group(hash);
+        for (size_t step = 1; ; step++){
+            unsigned mask = match_free(control + group * GROUP_WIDTH);
+            if (mask) return group * GROUP_WIDTH + lowest_bit(mask);
+            group = (group + step) & (groups - 1);
+        }
+    }
+    // Moves a new key and value into a free slot. The table must have room.
+    Slot& place(std::string&& key, T&& value, size_t hash){
+        size_t index = free_slot(hash);
+        if (control[index] == EMPTY) growthLeft--;
+        control[index] = hash_tag(hash);
+        new (slots + index) Slot{std::move(key), std::move(value)};
+        count++;
+        return slots[index];
+    }
+
+    size_t growth_limit(size_t cap) const {
+        return static_cast<size_t>(cap * maxLoad);
+    }
+    // Smallest power-of-two capacity that holds elements under the load factor.
+    size_t capacity_for(size_t elements) const {
+        size_t cap = MIN_CAPACITY;
+        while (growth_limit(cap) < elements) cap *= 2;
+        return cap;
+    }
+    // Moves every element into a fresh table of newCapacity slots, dropping
+    // the deleted markers along the way.
+    void rehash(size_t newCapacity){
+        signed char* oldControl = control;
+        Slot* oldSlots = slots;
+        size_t oldCapacity = capacity;
+        control = static_cast<signed char*>(Allocator::allocate(newCapacity));
+        slots = static_cast<Slot*>(Allocator::allocate(newCapacity * sizeof(Slot)));
+        std::memset(control, EMPTY, newCapacity);
+        capacity = newCapacity;
+        count = 0;
+        growthLeft = growth_limit(newCapacity);
+        for (size_t i = 0; i < oldCapacity; i++){
+            if (oldControl[i] < 0) continue;
+            Slot& old = oldSlots[i];
+            place(std::move(old.key), std::move(old.value), hash_key(old.key));
+            old.~Slot();
+        }
+        release(oldControl, oldSlots, oldCapacity);
+    }
+    // Makes room for one more insert, growing only if the table is really
+    // full; a table clogged with deleted slots is rebuilt at the same size.
+    void prepare_insert(){
+        if (growthLeft > 0) return;
+        if (capacity == 0) rehash(MIN_CAPACITY);
+        else if (count * 2 >= growth_limit(capacity)) rehash(capacity * 2);
+        else rehash(capacity);
+    }
+    void destroy_all(){
+        for (size_t i = 0; i < capacity; i++){
+            if (control[i] >= 0) slots[i].~Slot();
+        }
+    }
+    static void release(signed char* ctrl, Slot* data, size_t cap){
+        if (!cap) return;
+        Allocator::deallocate(ctrl, cap);
+        Allocator::deallocate(data, cap * sizeof(Slot));
+    }
+    void erase_slot(size_t index){
+        slots[index].~Slot();
+        // A group that still has an empty slot already ends every probe that
+        // reaches it, so the slot can go back to empty. Otherwise later keys
+        // may have probed past it and it has to stay a deleted marker.
+        const signed char* group = control + (index & ~(GROUP_WIDTH - 1));
+        if (match(group, EMPTY)) {
+            control[index] = EMPTY;
+            growthLeft++;
+        }
+        else control[index] = DELETED;
+        count--;
+    }
+
+public:
+    G_Dictionary() : control(nullptr), slots(nullptr), capacity(0), count(0), growthLeft(0), maxLoad(0.875f) {}
+    G_Dictionary(const G_Dictionary& other)
+        : control(nullptr), slots(nullptr), capacity(0), count(0), growthLeft(0), maxLoad(other.maxLoad) {
+        reserve(other.count);
+        for (size_t i = 0; i < other.capacity; i++){
+            if (other.control[i] < 0) continue;
+            std::string key = other.slots[i].key;
+            T value = other.slots[i].value;
+            size_t hash = hash_key(key);
+            place(std::move(key), std::move(value), hash);
+        }
+    }
+    G_Dictionary& operator=(const G_Dictionary& other){
+        if (this != &other) {
+            G_Dictionary copy(other);
+            std::swap(control, copy.control);
+            std::swap(slots, copy.slots);
+            std::swap(capacity, copy.capacity);
+            std::swap(count, copy.count);
+            std::swap(growthLeft, copy.growthLeft);
+            std::swap(maxLoad, copy.maxLoad);
+        }
+        return *this;
+    }
+    ~G_Dictionary(){
+        destroy_all();
+        release(control, slots, capacity);
+    }
+
+    // Overloading the [] operator to allow accessing a value in the style
+    // Dictionary[key]. A missing key is added with a default value.
+    T& operator[](std::string_view key){
+        Logger l = Logger("[] operator within Dictionary");
+        size_t hash = hash_key(key);
+        size_t index = find_slot(key, hash);
+        if (index != capacity) return slots[index].value;
+        std::cout << "Requested key not found within dictionary.\n";
+        prepare_insert();
+        return place(std::string(key), T(), hash).value;
+    }
+
+    size_t length(){
+        Logger l = Logger("length");
+        return count;
+    }
+
+    // Add pair, or replace the value if key is already present.
+    // Returns true if key was new.
+    bool add_pair(std::string key, T value){
+        size_t hash = hash_key(key);
+        size_t index = find_slot(key, hash);
+        if (index != capacity) {
+            slots[index].value = std::move(value);
+            return false;
+        }
+        prepare_insert();
+        place(std::move(key), std::move(value), hash);
+        return true;
+    }
+
+    // Remove pair
+    void remove_pair(std::string_view key){
+        if (erase(key)) std::cout << "Removed " << key << '\n';
+        else std::cout << "Couldn't remove " << key << ": key not found.\n";
+    }
+
+    // Quiet lookups. find returns a pointer to key's value, or nullptr.
+    // These take std::string, string_view and const char* without copying.
+    T* find(std::string_view key){
+        size_t index = find_slot(key, hash_key(key));
+        return index == capacity ? nullptr : &slots[index].value;
+    }
+    const T* find(std::string_view key) const {
+        size_t index = find_slot(key, hash_key(key));
+        return index == capacity ? nullptr : &slots[index].value;
+    }
+    bool contains(std::string_view key) const {
+        return find(key) != nullptr;
+    }
+    // Removes key and returns true, or returns false if it wasn't present.
+    bool erase(std::string_view key){
+        size_t index = find_slot(key, hash_key(key));
+        if (index == capacity) return false;
+        erase_slot(index);
+        return true;
+    }
+
+    // Removes every pair but keeps the table's size.
+    void clear(){
+        if (!capacity) return;
+        destroy_all();
+        std::memset(control, EMPTY, capacity);
+        count = 0;
+        growthLeft = growth_limit(capacity);
+    }
+
+    // Writes every pair to path as a G_Snapshot. Values must be trivially
+    // copyable or std::string.
+    bool save_snapshot(const std::string& path) const {
+        Logger l = Logger("save_snapshot");
+        static_assert(G_Snapshot::storable<T>(), "snapshots hold std::string or trivially copyable values");
+        G_Snapshot::Writer writer;
+        for (size_t i = 0; i < capacity; i++){
+            if (control[i] < 0) continue;
+            writer.put_text(slots[i].key);
+            writer.put(slots[i].value);
+        }
+        G_Snapshot::Header header = G_Snapshot::make_header(G_Snapshot::KIND_DICTIONARY,
+            G_Snapshot::element_type<T>(), G_Snapshot::element_size<T>(), count, writer.data(), writer.size());
+        return G_Snapshot::write_file(path, header, writer.data());
+    }
+    // Replaces the contents with a snapshot written by save_snapshot. The
+    // table is sized once up front and keys are read in place from the
+    // mapped file. Returns false, leaving the dictionary empty, on failure.
+    bool load_snapshot(const std::string& path){
+        Logger l = Logger("load_snapshot");
+        static_assert(G_Snapshot::storable<T>(), "snapshots hold std::string or trivially copyable values");
+        clear();
+        G_Snapshot::Mapping file;
+        G_Snapshot::Header header;
+        const unsigned char* payload = G_Snapshot::open_file(file, path, G_Snapshot::KIND_DICTIONARY,
+            G_Snapshot::element_type<T>(), G_Snapshot::element_size<T>(), header);
+        if (!payload) return false;
+        reserve(header.count);
+        G_Snapshot::Reader reader(payload, header.payloadBytes);
+        std::string_view key;
+        T value = T();
+        for (uint64_t i = 0; i < header.count; i++){
+            if (!reader.get_text(key) || !reader.get(value)) break;
+            add_pair(std::string(key), std::move(value));
+        }
+        if (count == header.count && reader.finished()) return true;
+        std::cout << "Snapshot " << path << " is inconsistent.\n";
+        clear();
+        return false;
+    }
+
+    // Sizes the table so that count keys fit without rehashing.
+    void reserve(size_t keys){
+        if (keys == 0) return;
+        size_t needed = capacity_for(keys);
+        if (needed > capacity) rehash(needed);
+    }
+    float load_factor() const {
+        return capacity ? static_cast<float>(count) / capacity : 0.0f;
+    }
+    float max_load_factor() const {
+        return maxLoad;
+    }
+    // Highest fraction of slots in use before the table grows. Lower values
+    // trade memory for shorter probes. Clamped to [0.25, 0.9375].
+    void max_load_factor(float factor){
+        if (factor < 0.25f) factor = 0.25f;
+        if (factor > 0.9375f) factor = 0.9375f;
+        maxLoad = factor;
+        if (capacity) rehash(capacity_for(count));
+    }
+
+    std::ostream& operator<<(std::ostream& os){
+        for (size_t i = 0; i < capacity; i++){
+            if (control[i] >= 0) std::cout << slots[i].key << ',' << slots[i].value << '\t';
+        }
+        return os;
+    }
+};
+
+/*
+    G_ConcurrentDictionary is a string-keyed map that many threads can use at
+    once. Keys are spread over a power-of-two number of shards by their hash,
+    and each shard is a G_Dictionary with its own reader-writer lock: any
+    number of threads can read a shard together, and threads working on
+    different shards never wait on each other.
+
+    find copies the value out, since a reference would outlive the lock.
+    Every shard counts its reads and writes and how many of them found the
+    lock already taken; shard_stats() and report() show how evenly the load
+    and the contention are spread.
+*/
+template <typename T, typename Allocator = G_HeapAllocator>
+class G_ConcurrentDictionary {
+public:
+    struct ShardStats {
+        size_t size;
+        float loadFactor;
+        uint64_t reads;
+        uint64_t writes;
+        uint64_t contendedReads;   // reads that had to wait for a writer
+        uint64_t contendedWrites;  // writes that had to wait for anyone
+    };
+
+    // shards = 0 picks four shards per hardware thread. Other counts are
+    // rounded up to a power of two.
+    explicit G_ConcurrentDictionary(size_t shards = 0){
+        size_t wanted = shards ? shards : 4 * std::max(1u, std::thread::hardware_concurrency());
+        shardCount = 1;
+        shardBits = 0;
+        while (shardCount < wanted) {
+            shardCount *= 2;
+            shardBits++;
+        }
+        shardArray = new Shard[shardCount];
+    }
+    G_ConcurrentDictionary(const G_ConcurrentDictionary&) = delete;
+    G_ConcurrentDictionary& operator=(const G_ConcurrentDictionary&) = delete;
+    ~G_ConcurrentDictionary(){
+        delete[] shardArray;
+    }
+
+    // Sets key's value, adding key if it's new. Returns true if it was new.
+    bool insert_or_assign(std::string key, T value){
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.lock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            shard.contendedWrites.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+        shard.writes.fetch_add(1, std::memory_order_relaxed);
+        bool added = shard.map.add_pair(std::move(key), std::move(value));
+        if (added) shard.size.fetch_add(1, std::memory_order_relaxed);
+        return added;
+    }
+    // Copies key's value into out and returns true, or returns false.
+    bool find(std::string_view key, T& out) const {
+        Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.lock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            shard.contendedReads.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+        shard.reads.fetch_add(1, std::memory_order_relaxed);
+        const T* value = shard.map.find(key);
+        if (!value) return false;
+        out = *value;
+        return true;
+    }
+    bool contains(std::string_view key) const {
+        Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.lock);
+        shard.reads.fetch_add(1, std::memory_order_relaxed);
+        return shard.map.contains(key);
+    }
+    // Removes key and returns true, or returns false if it wasn't present.
+    bool erase(std::string_view key){
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.lock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            shard.contendedWrites.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+        shard.writes.fetch_add(1, std::memory_order_relaxed);
+        bool erased = shard.map.erase(key);
+        if (erased) shard.size.fetch_sub(1, std::memory_order_relaxed);
+        return erased;
+    }
+
+    // Number of keys. Exact only while no other thread is writing.
+    size_t length() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount; i++) total += shardArray[i].size.load(std::memory_order_relaxed);
+        return total;
+    }
+    size_t shard_count() const {
+        return shardCount;
+    }
+    ShardStats shard_stats(size_t index) const {
+        Shard& shard = shardArray[index];
+        ShardStats stats;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.lock);
+            stats.size = shard.size.load(std::memory_order_relaxed);
+            stats.loadFactor = shard.map.load_factor();
+        }
+        stats.reads = shard.reads.load(std::memory_order_relaxed);
+        stats.writes = shard.writes.load(std::memory_order_relaxed);
+        stats.contendedReads = shard.contendedReads.load(std::memory_order_relaxed);
+        stats.contendedWrites = shard.contendedWrites.load(std::memory_order_relaxed);
+        return stats;
+    }
+    void reset_stats(){
+        for (size_t i = 0; i < shardCount; i++){
+            Shard& shard = shardArray[i];
+            shard.reads = 0;
+            shard.writes = 0;
+            shard.contendedReads = 0;
+            shard.contendedWrites = 0;
+        }
+    }
+    // Prints a line per shard, then the totals.
+    void report(std::ostream& os = std::cout) const {
+        uint64_t reads = 0, writes = 0, contended = 0;
+        size_t smallest = SIZE_MAX, largest = 0;
+        os << "shard      size  load    reads   writes  contended\n";
+        for (size_t i = 0; i < shardCount; i++){
+            ShardStats st = shard_stats(i);
+            os << std::setw(5) << i << std::setw(10) << st.size << std::setw(6) << std::fixed << std::setprecision(2)
+               << st.loadFactor << std::setw(9) << st.reads << std::setw(9) << st.writes
+               << std::setw(11) << st.contendedReads + st.contendedWrites << '\n';
+            os.unsetf(std::ios::fixed);
+            reads += st.reads;
+            writes += st.writes;
+            contended += st.contendedReads + st.contendedWrites;
+            smallest = std::min(smallest, st.size);
+            largest = std::max(largest, st.size);
+        }
+        os << "Total: " << length() << " keys (shards hold " << smallest << " to " << largest << "), "
+           << reads << " reads, " << writes << " writes, " << contended << " contended.\n";
+    }
+
+    // Runs a mixed workload (90% find, 9% insert_or_assign, 1% erase) over a
+    // shared table with 1, 2, 4 and all hardware threads, and prints the
+    // throughput and contention of each.
+    static void Benchmark(size_t keyCount = 1 << 16, size_t opsPerThread = 1 << 20){
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Beginning G_ConcurrentDictionary benchmark (" << keyCount << " keys, "
+                  << opsPerThread << " ops per thread, " << hardware << " hardware threads).\n";
+        std::string* keys = new std::string[keyCount];
+        for (size_t i = 0; i < keyCount; i++) keys[i] = "key_" + std::to_string(i * 2654435761u);
+
+        unsigned counts[] = {1, 2, 4, hardware};
+        for (size_t c = 0; c < 4; c++){
+            unsigned threads = counts[c];
+            if (c == 3 && threads <= 4) break;
+            G_ConcurrentDictionary table;
+            for (size_t i = 0; i < keyCount; i += 2) table.insert_or_assign(keys[i], T());
+            table.reset_stats();
+
+            std::thread* workers = new std::thread[threads];
+            auto begin = std::chrono::steady_clock::now();
+            for (unsigned t = 0; t < threads; t++){
+                workers[t] = std::thread([&table, keys, keyCount, opsPerThread, t]{
+                    std::mt19937 rng(t + 1);
+                    T value = T();
+                    for (size_t op = 0; op < opsPerThread; op++){
+                        uint32_t r = rng();
+                        const std::string& key = keys[(r >> 7) % keyCount];
+                        uint32_t kind = r % 100;
+                        if (kind < 90) table.find(key, value);
+                        else if (kind < 99) table.insert_or_assign(key, value);
+                        else table.erase(key);
+                    }
+                });
+            }
+            for (unsigned t = 0; t < threads; t++) workers[t].join();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            delete[] workers;
+
+            uint64_t contended = 0;
+            for (size_t i = 0; i < table.shard_count(); i++){
+                ShardStats st = table.shard_stats(i);
+                contended += st.contendedReads + st.contendedWrites;
+            }
+            double ops = double(threads) * opsPerThread;
+            std::cout << std::setw(4) << threads << " thread(s): " << std::fixed << std::setprecision(2)
+                      << ops / seconds / 1e6 << " Mops/s, " << std::setprecision(3)
+                      << 100.0 * contended / ops << "% of operations waited for a lock.\n";
+            std::cout.unsetf(std::ios::fixed);
+        }
+        delete[] keys;
+    }
+
+private:
+    // Aligned to a cache line so neighbouring shards' locks and counters
+    // don't share one.
+    struct alignas(64) Shard {
+        std::shared_mutex lock;
+        G_Dictionary<T, Allocator> map;
+        std::atomic<size_t> size{0};
+        std::atomic<uint64_t> reads{0};
+        std::atomic<uint64_t> writes{0};
+        std::atomic<uint64_t> contendedReads{0};
+        std::atomic<uint64_t> contendedWrites{0};
+    };
+    Shard* shardArray;
+    size_t shardCount;
+    unsigned shardBits;
+
+    // Uses the top bits of the (remixed) hash; G_Dictionary uses the low ones
+    // inside the shard, so the two choices don't correlate.
+    Shard& shard_for(std::string_view key) const {
+        uint64_t hash = G_StringHash()(key);
+        hash *= 0x9E3779B97F4A7C15ull;
+        return shardArray[shardBits ? hash >> (64 - shardBits) : 0];
+    }
+};
+
+/*
+    Helpers shared by the lock-free containers' tests and benchmarks.
 */
-class FancyText {
-private:
-    static inline std::string RED = "\e[31m";
-    static inline std::string GREEN = "\e[32m";
-    static inline std::string YELLOW = "\e[33m";
-    static inline std::string NORMAL = "\e[0m";
+class G_Concurrency {
 public:
-    /*
-        Print the given text in a color provided by FancyText. Use the color's
-        name's first character to select a color. If a newline is needed after
-        what is being printed, pass a boolean true as the third parameter.
-        Newline defaults to false, color defaults to white.
-    */
-    static void print_colored(std::string text, char col = '\0', bool newline = false){
-        Logger l = Logger("print_colored");
-        std::string color;
-        if (col == 'r') color = RED;
-        else if (col == 'y') color = YELLOW;
-        else if (col == 'g') color = GREEN;
-        else color = NORMAL;
-        std::cout << color << text << NORMAL << newline ? '\n' : '\0';
+    // Runs body(threadIndex) on threads threads and returns the wall time.
+    template <typename Body>
+    static double run_threads(unsigned threads, Body body){
+        // A plain buffer: G_Array logs on every add and index, which would be timed too.
+        std::unique_ptr<std::thread[]> workers(new std::thread[threads]);
+        auto begin = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; t++) workers[t] = std::thread(body, t);
+        for (unsigned t = 0; t < threads; t++) workers[t].join();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+    static void print_rate(unsigned threads, double operations, double seconds){
+        std::cout << std::setw(4) << threads << " thread(s): " << std::fixed << std::setprecision(2)
+                  << operations / seconds / 1e6 << " Mops/s\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    // Rounds up to a power of two, at least 2.
+    static size_t ring_capacity(size_t wanted){
+        size_t capacity = 2;
+        while (capacity < wanted) capacity *= 2;
+        return capacity;
     }
 };
 
 /*
-    A basic implementation of a dictionary that supports key-value pairs between
-    a string (always) and another type. The second type is templated.
-    I may eventually support non-string keys, but I don't want to implement that yet.
+    Lock-free containers for handing work and messages between threads.
+    None of them block: every operation either succeeds or reports that the
+    container was empty (or full) right then, and the caller decides whether
+    to retry, yield or do something else.
+
+    G_TreiberStack is an intrusive LIFO stack: items derive from G_StackHook,
+    which carries the link, so pushing never allocates. The head pointer
+    carries a 16-bit tag in its unused top bits (user-space addresses fit in
+    48 bits on x86-64 and AArch64) that changes on every update, so a pop
+    that read the head just before another thread popped that node and
+    pushed it back (the ABA problem) fails its compare-and-swap and retries.
+    Items must stay allocated while any thread may still be popping, which
+    is how a free list of recycled objects uses it anyway.
 */
+struct G_StackHook {
+    std::atomic<G_StackHook*> stackNext{nullptr};
+};
 template <typename T>
-class G_Dictionary {
+class G_TreiberStack {
+    static_assert(std::is_base_of<G_StackHook, T>::value, "G_TreiberStack items must derive from G_StackHook");
+    static_assert(sizeof(void*) == 8, "G_TreiberStack packs its tag into 64-bit pointers");
+public:
+    G_TreiberStack() : head(0) {}
+    G_TreiberStack(const G_TreiberStack&) = delete;
+    G_TreiberStack& operator=(const G_TreiberStack&) = delete;
+
+    void push(T* item){
+        G_StackHook* node = item;
+        uint64_t old = head.load(std::memory_order_relaxed);
+        do {
+            node->stackNext.store(pointer_of(old), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(old, pack(node, tag_of(old) + 1),
+                                             std::memory_order_release, std::memory_order_relaxed));
+    }
+    // Returns the most recently pushed item, or nullptr if the stack is empty.
+    T* pop(){
+        uint64_t old = head.load(std::memory_order_acquire);
+        while (G_StackHook* node = pointer_of(old)) {
+            uint64_t next = pack(node->stackNext.load(std::memory_order_relaxed), tag_of(old) + 1);
+            if (head.compare_exchange_weak(old, next, std::memory_order_acquire, std::memory_order_acquire))
+                return static_cast<T*>(node);
+        }
+        return nullptr;
+    }
+    bool empty() const {
+        return pointer_of(head.load(std::memory_order_acquire)) == nullptr;
+    }
+
+    // Threads pop items, then push them back; afterwards every item must
+    // still be on the stack exactly once. Returns true if it was.
+    static bool StressTest(unsigned threads = 4, size_t itemsPerThread = 1000, size_t rounds = 200000){
+        struct Item : G_StackHook { size_t id; };
+        size_t total = threads * itemsPerThread;
+        Item* items = new Item[total];
+        G_TreiberStack<Item> stack;
+        for (size_t i = 0; i < total; i++){
+            items[i].id = i;
+            stack.push(&items[i]);
+        }
+        G_Array<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++){
+            workers.add_element(std::thread([&stack, rounds, t]{
+                std::mt19937 rng(t + 1);
+                Item* held[8];
+                for (size_t r = 0; r < rounds; r++){
+                    size_t want = 1 + rng() % 8, got = 0;
+                    while (got < want && (held[got] = stack.pop())) got++;
+                    while (got) stack.push(held[--got]);
+                }
+            }));
+        }
+        for (unsigned t = 0; t < threads; t++) workers[t].join();
+        G_Array<char> seen;
+        for (size_t i = 0; i < total; i++) seen.add_element(0);
+        size_t found = 0;
+        bool ok = true;
+        while (Item* item = stack.pop()){
+            if (item->id >= total || seen[item->id]) ok = false;
+            else seen[item->id] = 1;
+            found++;
+        }
+        ok = ok && found == total;
+        std::cout << "G_TreiberStack stress test: " << found << " of " << total << " items recovered, "
+                  << (ok ? "passed" : "FAILED") << ".\n";
+        delete[] items;
+        return ok;
+    }
+    // Each thread repeatedly pops one item and pushes it back.
+    static void Benchmark(size_t opsPerThread = 1 << 20){
+        struct Item : G_StackHook {};
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Beginning G_TreiberStack benchmark (" << opsPerThread << " pop/push pairs per thread).\n";
+        unsigned counts[] = {1, 2, 4, hardware};
+        for (size_t c = 0; c < 4; c++){
+            unsigned threads = counts[c];
+            if (c == 3 && threads <= 4) break;
+            G_TreiberStack<Item> stack;
+            Item* items = new Item[threads * 4];
+            for (unsigned i = 0; i < threads * 4; i++) stack.push(&items[i]);
+            double seconds = G_Concurrency::run_threads(threads, [&](unsigned){
+                for (size_t op = 0; op < opsPerThread; op++){
+                    Item* item = stack.pop();
+                    if (item) stack.push(item);
+                }
+            });
+            G_Concurrency::print_rate(threads, 2.0 * threads * opsPerThread, seconds);
+            delete[] items;
+        }
+    }
+
 private:
-    // These are parallel arrays, and special attention is paid to them in order
-    // to avoid any indexing errors.
-    G_Array<std::string> keys;
-    G_Array<T> values;
+    static const int TAG_SHIFT = 48;
+    static const uint64_t POINTER_MASK = (uint64_t(1) << TAG_SHIFT) - 1;
+
+    alignas(64) std::atomic<uint64_t> head;
+
+    static G_StackHook* pointer_of(uint64_t packed){
+        return reinterpret_cast<G_StackHook*>(packed & POINTER_MASK);
+    }
+    static uint64_t tag_of(uint64_t packed){
+        return packed >> TAG_SHIFT;
+    }
+    static uint64_t pack(G_StackHook* node, uint64_t tag){
+        return (reinterpret_cast<uint64_t>(node) & POINTER_MASK) | (tag << TAG_SHIFT);
+    }
+};
+
+/*
+    G_SpscRing is a bounded FIFO for exactly one producer thread and one
+    consumer thread. Each side owns one index and only reads the other's
+    when its cached copy says the ring looks full (or empty), so in steady
+    state the two threads rarely touch the same cache line.
+*/
+template <typename T, typename Allocator = G_HeapAllocator>
+class G_SpscRing {
 public:
-    // Overloading the [] operator to allow accessing a value in the style
-    // Dictionary[key] 
-    T& operator[](std::string key){
-        Logger l = Logger("[] operator within Dictionary");
-        int keyIndex = -1;
-        for (int i = 0; i < keys.length(); i++){
-            if (keys[i] == key) keyIndex = i;
+    // Capacity is rounded up to a power of two.
+    explicit G_SpscRing(size_t capacity)
+        : capacity(G_Concurrency::ring_capacity(capacity)), mask(this->capacity - 1),
+          headPos(0), cachedTail(0), tailPos(0), cachedHead(0) {
+        slots = static_cast<T*>(Allocator::allocate(this->capacity * sizeof(T)));
+    }
+    G_SpscRing(const G_SpscRing&) = delete;
+    G_SpscRing& operator=(const G_SpscRing&) = delete;
+    ~G_SpscRing(){
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        for (size_t i = headPos.load(std::memory_order_relaxed); i != tail; i++) slots[i & mask].~T();
+        Allocator::deallocate(slots, capacity * sizeof(T));
+    }
+
+    // Producer only. Returns false, leaving value alone, if the ring is full.
+    template <typename U>
+    bool try_push(U&& value){
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        if (tail - cachedHead == capacity) {
+            cachedHead = headPos.load(std::memory_order_acquire);
+            if (tail - cachedHead == capacity) return false;
         }
-        if (keyIndex == -1){
-            std::cout << "Requested key not found within dictionary.\n";
+        new (slots + (tail & mask)) T(std::forward<U>(value));
+        tailPos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer only. Returns false if the ring is empty.
+    bool try_pop(T& out){
+        size_t head = headPos.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tailPos.load(std::memory_order_acquire);
+            if (head == cachedTail) return false;
         }
-        else return values[keyIndex];
+        T* slot = slots + (head & mask);
+        out = std::move(*slot);
+        slot->~T();
+        headPos.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    size_t get_capacity() const {
+        return capacity;
     }
 
-    size_t length(){
-        Logger l = Logger("length");
-        return keys.length();
+    // Sends 0..count-1 through a small ring; the consumer must see every
+    // number once, in order.
+    static bool StressTest(size_t count = 1 << 22){
+        G_SpscRing<size_t> ring(64);
+        bool ok = true;
+        std::thread consumer([&]{
+            size_t expected = 0, value;
+            while (expected < count){
+                if (!ring.try_pop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (value != expected) ok = false;
+                expected++;
+            }
+        });
+        for (size_t i = 0; i < count; i++){
+            while (!ring.try_push(i)) std::this_thread::yield();
+        }
+        consumer.join();
+        std::cout << "G_SpscRing stress test: " << count << " items, " << (ok ? "passed" : "FAILED") << ".\n";
+        return ok;
+    }
+    static void Benchmark(size_t count = 1 << 24, size_t capacity = 1024){
+        std::cout << "Beginning G_SpscRing benchmark (" << count << " items through " << capacity << " slots).\n";
+        G_SpscRing<size_t> ring(capacity);
+        double seconds = G_Concurrency::run_threads(2, [&](unsigned side){
+            size_t value;
+            for (size_t i = 0; i < count; i++){
+                if (side == 0) { while (!ring.try_push(i)) std::this_thread::yield(); }
+                else { while (!ring.try_pop(value)) std::this_thread::yield(); }
+            }
+        });
+        G_Concurrency::print_rate(2, double(count), seconds);
     }
 
-    // Add pair
-    void add_pair(std::string key, T value){
-        keys.add_element(key);
-        values.add_element(value);
+private:
+    T* slots;
+    const size_t capacity;
+    const size_t mask;
+    // Consumer's line: its index and its copy of the producer's.
+    alignas(64) std::atomic<size_t> headPos;
+    size_t cachedTail;
+    // Producer's line.
+    alignas(64) std::atomic<size_t> tailPos;
+    size_t cachedHead;
+};
+
+/*
+    G_MpmcQueue is a bounded FIFO any number of threads can push to and pop
+    from (Dmitry Vyukov's design). Every slot has a sequence number saying
+    whose turn it is: a producer claims a slot with one compare-and-swap on
+    the enqueue index, fills it, then bumps the slot's sequence to hand it to
+    consumers, and consumers do the reverse. Producers and consumers only
+    meet on a slot when the queue is nearly full or empty.
+*/
+template <typename T, typename Allocator = G_HeapAllocator>
+class G_MpmcQueue {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit G_MpmcQueue(size_t capacity)
+        : capacity(G_Concurrency::ring_capacity(capacity)), mask(this->capacity - 1), enqueuePos(0), dequeuePos(0) {
+        cells = static_cast<Cell*>(Allocator::allocate(this->capacity * sizeof(Cell)));
+        for (size_t i = 0; i < this->capacity; i++) new (&cells[i].sequence) std::atomic<size_t>(i);
+    }
+    G_MpmcQueue(const G_MpmcQueue&) = delete;
+    G_MpmcQueue& operator=(const G_MpmcQueue&) = delete;
+    ~G_MpmcQueue(){
+        T discard;
+        while (try_pop(discard)) {}
+        for (size_t i = 0; i < capacity; i++) cells[i].sequence.~atomic();
+        Allocator::deallocate(cells, capacity * sizeof(Cell));
     }
 
-    // Remove pair
-    void remove_pair(std::string key){
-        int keyIndex = -1;
-        for (int i = 0; i < keys.length(); i++){
-            if (keys[i] == key) keyIndex = i;
+    // Returns false, leaving value alone, if the queue is full.
+    template <typename U>
+    bool try_push(U&& value){
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;){
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t turn = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (turn == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (cell.item()) T(std::forward<U>(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0) return false;
+            else pos = enqueuePos.load(std::memory_order_relaxed);
         }
-        if (keyIndex == -1) {
-            std::cout << "Couldn't remove " << key << ": key not found.\n";
+    }
+    // Returns false if the queue is empty.
+    bool try_pop(T& out){
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;){
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t turn = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (turn == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* item = cell.item();
+                    out = std::move(*item);
+                    item->~T();
+                    cell.sequence.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (turn < 0) return false;
+            else pos = dequeuePos.load(std::memory_order_relaxed);
         }
-        else {
-            keys.remove_element(keyIndex);
-            values.remove_element(keyIndex);
-            std::cout << "Removed " << key << '\n';
+    }
+    size_t get_capacity() const {
+        return capacity;
+    }
+
+    // producers threads each push count tagged numbers while consumers
+    // threads pop. Every item must arrive exactly once, and each consumer
+    // must see any one producer's items in the order they were pushed.
+    static bool StressTest(unsigned producers = 4, unsigned consumers = 4, size_t count = 1 << 18){
+        G_MpmcQueue<uint64_t> queue(256);
+        std::atomic<size_t> received(0);
+        std::atomic<uint64_t> sum(0);
+        std::atomic<bool> ordered(true);
+        size_t total = producers * count;
+        G_Concurrency::run_threads(producers + consumers, [&](unsigned t){
+            if (t < producers) {
+                for (uint64_t i = 0; i < count; i++){
+                    while (!queue.try_push((uint64_t(t) << 32) | i)) std::this_thread::yield();
+                }
+                return;
+            }
+            // Plain arrays here: G_Array's logging isn't meant for many threads.
+            int64_t* last = new int64_t[producers];
+            for (unsigned p = 0; p < producers; p++) last[p] = -1;
+            uint64_t value, localSum = 0;
+            while (received.load(std::memory_order_relaxed) < total){
+                if (!queue.try_pop(value)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                received.fetch_add(1, std::memory_order_relaxed);
+                int64_t index = static_cast<int64_t>(value & 0xFFFFFFFFu);
+                int64_t& previous = last[value >> 32];
+                if (index <= previous) ordered = false;
+                previous = index;
+                localSum += index;
+            }
+            sum.fetch_add(localSum);
+            delete[] last;
+        });
+        uint64_t expectedSum = uint64_t(producers) * (uint64_t(count) * (count - 1) / 2);
+        bool ok = received == total && sum == expectedSum && ordered;
+        std::cout << "G_MpmcQueue stress test: " << received << " of " << total << " items, "
+                  << (ok ? "passed" : "FAILED") << ".\n";
+        return ok;
+    }
+    // Equal numbers of producers and consumers moving count items in total.
+    static void Benchmark(size_t count = 1 << 22, size_t capacity = 1024){
+        unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Beginning G_MpmcQueue benchmark (" << count << " items through " << capacity << " slots).\n";
+        unsigned pairs[] = {1, 2, 4, hardware / 2};
+        for (size_t c = 0; c < 4; c++){
+            unsigned half = pairs[c];
+            if (c == 3 && half <= 4) break;
+            G_MpmcQueue<size_t> queue(capacity);
+            size_t perThread = count / half;
+            double seconds = G_Concurrency::run_threads(2 * half, [&](unsigned t){
+                size_t value;
+                for (size_t i = 0; i < perThread; i++){
+                    if (t < half) { while (!queue.try_push(i)) std::this_thread::yield(); }
+                    else { while (!queue.try_pop(value)) std::this_thread::yield(); }
+                }
+            });
+            G_Concurrency::print_rate(2 * half, double(perThread * half), seconds);
         }
     }
 
-    std::ostream& operator<<(std::ostream& os){
-        for (int i = 0; i < keys.length(); i++){
-            std::cout << keys[i] << ',' << values[i] << '\t';
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+        T* item(){ return reinterpret_cast<T*>(storage); }
+    };
+    Cell* cells;
+    const size_t capacity;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+/*
+    G_NodePool hands out fixed-size blocks for list nodes. Blocks are carved
+    from slabs that double in size as the pool grows (up to MAX_SLAB blocks),
+    and freed blocks go on a free list to be reused before any new slab, so a
+    list that grows and shrinks stops calling the allocator at all. Slabs
+    are only returned when the pool is destroyed.
+*/
+template <typename NodeType, typename Allocator = G_HeapAllocator>
+class G_NodePool {
+public:
+    G_NodePool() : slabs(nullptr), freeList(nullptr), nextBlock(nullptr), blocksLeft(0), slabBlocks(0) {}
+    G_NodePool(const G_NodePool&) = delete;
+    G_NodePool& operator=(const G_NodePool&) = delete;
+    ~G_NodePool(){
+        while (slabs) {
+            SlabHeader* next = slabs->next;
+            Allocator::deallocate(slabs, slabs->bytes);
+            slabs = next;
         }
-        return os;
+    }
+
+    // Raw storage for one NodeType; construct into it with placement new.
+    void* allocate(){
+        if (freeList) {
+            Block* block = freeList;
+            freeList = block->nextFree;
+            return block;
+        }
+        if (blocksLeft == 0) add_slab();
+        blocksLeft--;
+        return nextBlock++;
+    }
+    // Takes back storage from allocate(). The node must already be destroyed.
+    void release(void* storage){
+        Block* block = static_cast<Block*>(storage);
+        block->nextFree = freeList;
+        freeList = block;
+    }
+
+private:
+    static constexpr size_t FIRST_SLAB = 16;
+    static constexpr size_t MAX_SLAB = 4096;
+
+    union Block {
+        Block* nextFree;
+        alignas(NodeType) unsigned char storage[sizeof(NodeType)];
+    };
+    struct SlabHeader {
+        SlabHeader* next;
+        size_t bytes;
+    };
+
+    SlabHeader* slabs;
+    Block* freeList;
+    Block* nextBlock;
+    size_t blocksLeft;
+    size_t slabBlocks;
+
+    void add_slab(){
+        slabBlocks = slabBlocks ? std::min(slabBlocks * 2, MAX_SLAB) : FIRST_SLAB;
+        // The blocks start after the header, rounded up to their alignment.
+        size_t offset = (sizeof(SlabHeader) + alignof(Block) - 1) / alignof(Block) * alignof(Block);
+        size_t bytes = offset + slabBlocks * sizeof(Block);
+        SlabHeader* slab = static_cast<SlabHeader*>(Allocator::allocate(bytes));
+        slab->next = slabs;
+        slab->bytes = bytes;
+        slabs = slab;
+        nextBlock = reinterpret_cast<Block*>(reinterpret_cast<unsigned char*>(slab) + offset);
+        blocksLeft = slabBlocks;
     }
 };
 
@@ -440,132 +4972,614 @@ template<typename T>
 struct Node {
     T data;
     Node* next;
+    Node* prev;
 };
-template<typename T>
+/*
+    G_List is a doubly linked list. It keeps a tail pointer and its length,
+    so adding or removing at either end and asking for the size are O(1).
+    Nodes come from the list's own G_NodePool, which recycles the nodes of
+    removed elements instead of freeing them.
+
+    October 19: Reworked from a singly linked list that walked to the end for
+    every push_back, pop and delete_back, and whose length went wrong after a
+    push_back.
+    October 19: Added iterators, insert and erase at an iterator, splice and
+    sort. splice moves nodes between lists without copying, so a list can end
+    up holding nodes from another list's pool; it keeps a reference to every
+    such pool, which stays alive until no list holding its nodes is left.
+    Those references, and the pools' slabs, are held until the list is
+    destroyed: clear() does not drop them. Recording a pool the list hasn't
+    borrowed from before is the one part of splice that can allocate, and it
+    scans the (usually tiny) list of pools already borrowed.
+*/
+template<typename T, typename Allocator = G_HeapAllocator>
 class G_List{
+    typedef G_NodePool<Node<T>, Allocator> Pool;
+
     Node<T>* head;
-    int length = 0;
+    Node<T>* tail;
+    size_t count;
+    std::shared_ptr<Pool> pool;
+    // Other lists' pools that nodes spliced into this list came from. A plain
+    // buffer, since G_Array logs on every add_element and contains.
+    std::unique_ptr<std::shared_ptr<Pool>[]> borrowedPools;
+    size_t borrowedCount = 0;
+    size_t borrowedCapacity = 0;
+
+    Node<T>* make_node(T value, Node<T>* prev, Node<T>* next){
+        return new (pool->allocate()) Node<T>{std::move(value), next, prev};
+    }
+    // Takes node out of the chain without destroying it.
+    void unlink(Node<T>* node){
+        if (node->prev) node->prev->next = node->next;
+        else head = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail = node->prev;
+        count--;
+    }
+    // Links an existing node in front of before, or at the end if before is
+    // null.
+    void link_node(Node<T>* before, Node<T>* node){
+        Node<T>* prev = before ? before->prev : tail;
+        node->prev = prev;
+        node->next = before;
+        if (prev) prev->next = node;
+        else head = node;
+        if (before) before->prev = node;
+        else tail = node;
+        count++;
+    }
+    // Unlinks node, destroys it and returns its storage to the pool.
+    void remove_node(Node<T>* node){
+        unlink(node);
+        node->~Node<T>();
+        pool->release(node);
+    }
+    // Links a new node holding value in front of before, or at the end if
+    // before is null.
+    Node<T>* link_before(Node<T>* before, T value){
+        Node<T>* node = make_node(std::move(value), nullptr, nullptr);
+        link_node(before, node);
+        return node;
+    }
+    // Keeps alive every pool other's nodes may have come from.
+    void adopt_pools(const G_List& other){
+        adopt_pool(other.pool);
+        for (size_t i = 0; i < other.borrowedCount; i++) adopt_pool(other.borrowedPools[i]);
+    }
+    void adopt_pool(const std::shared_ptr<Pool>& source){
+        if (source == pool) return;
+        for (size_t i = 0; i < borrowedCount; i++){
+            if (borrowedPools[i] == source) return;
+        }
+        if (borrowedCount == borrowedCapacity) {
+            size_t grown = borrowedCapacity ? borrowedCapacity * 2 : 4;
+            std::unique_ptr<std::shared_ptr<Pool>[]> larger(new std::shared_ptr<Pool>[grown]);
+            for (size_t i = 0; i < borrowedCount; i++) larger[i] = std::move(borrowedPools[i]);
+            borrowedPools = std::move(larger);
+            borrowedCapacity = grown;
+        }
+        borrowedPools[borrowedCount++] = source;
+    }
+    // Merges two sorted null-terminated chains through their next links.
+    // Ties take from left, which keeps the sort stable.
+    template <typename Compare>
+    static Node<T>* merge_chains(Node<T>* left, Node<T>* right, Compare& comp){
+        Node<T>* merged;
+        Node<T>** link = &merged;
+        while (left && right){
+            if (comp(right->data, left->data)) {
+                *link = right;
+                right = right->next;
+            }
+            else {
+                *link = left;
+                left = left->next;
+            }
+            link = &(*link)->next;
+        }
+        *link = left ? left : right;
+        return merged;
+    }
+
 public:
-    G_List() : head(NULL){}
+    // Forward iterator; Const selects the const_iterator flavour. end() is a
+    // null node.
+    template <bool Const>
+    class Iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const T*, T*>::type pointer;
+        typedef typename std::conditional<Const, const T&, T&>::type reference;
+        Iterator() : node(nullptr) {}
+        explicit Iterator(Node<T>* node) : node(node) {}
+        // Lets an iterator become a const_iterator.
+        operator Iterator<true>() const { return Iterator<true>(node); }
+
+        reference operator*() const { return node->data; }
+        pointer operator->() const { return &node->data; }
+        Iterator& operator++(){
+            node = node->next;
+            return *this;
+        }
+        Iterator operator++(int){
+            Iterator before = *this;
+            node = node->next;
+            return before;
+        }
+        bool operator==(const Iterator& other) const { return node == other.node; }
+        bool operator!=(const Iterator& other) const { return node != other.node; }
+
+    private:
+        friend class G_List;
+        Node<T>* node;
+    };
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    G_List() : head(nullptr), tail(nullptr), count(0), pool(std::make_shared<Pool>()) {}
+    G_List(const G_List& other) : head(nullptr), tail(nullptr), count(0), pool(std::make_shared<Pool>()) {
+        for (Node<T>* node = other.head; node; node = node->next) push_back(node->data);
+    }
+    G_List& operator=(const G_List& other){
+        if (this != &other) {
+            clear();
+            for (Node<T>* node = other.head; node; node = node->next) push_back(node->data);
+        }
+        return *this;
+    }
+    ~G_List(){
+        clear();
+    }
+
+    iterator begin(){ return iterator(head); }
+    iterator end(){ return iterator(); }
+    const_iterator begin() const { return const_iterator(head); }
+    const_iterator end() const { return const_iterator(); }
+
+    // Inserts value before pos and returns an iterator to it. O(1).
+    iterator insert(const_iterator pos, T value){
+        return iterator(link_before(pos.node, std::move(value)));
+    }
+    // Removes the element at pos and returns an iterator to the next one. O(1).
+    iterator erase(const_iterator pos){
+        Node<T>* next = pos.node->next;
+        remove_node(pos.node);
+        return iterator(next);
+    }
+
+    // Moves every element of other in front of pos, leaving other empty.
+    // No elements are copied or allocated. O(1).
+    void splice(const_iterator pos, G_List& other){
+        if (&other == this || !other.head) return;
+        adopt_pools(other);
+        Node<T>* before = pos.node;
+        Node<T>* prev = before ? before->prev : tail;
+        other.head->prev = prev;
+        other.tail->next = before;
+        if (prev) prev->next = other.head;
+        else head = other.head;
+        if (before) before->prev = other.tail;
+        else tail = other.tail;
+        count += other.count;
+        other.head = nullptr;
+        other.tail = nullptr;
+        other.count = 0;
+    }
+    // Moves the single element at it from other (which may be this list) in
+    // front of pos. O(1).
+    void splice(const_iterator pos, G_List& other, const_iterator it){
+        Node<T>* node = it.node;
+        if (&other == this && (node == pos.node || node->next == pos.node)) return;
+        if (&other != this) adopt_pools(other);
+        other.unlink(node);
+        link_node(pos.node, node);
+    }
+
+    // Stable O(n log n) sort with the same functors as G_Array::sort. Only
+    // relinks nodes: nothing is allocated and no element is moved.
+    // Bottom-up merge sort: bins[i] holds a sorted run of 2^i nodes, and each
+    // node carries into the bins like a binary counter.
+    template <typename Compare>
+    void sort(Compare comp){
+        if (count < 2) return;
+        Node<T>* bins[64] = {};
+        Node<T>* node = head;
+        while (node){
+            Node<T>* next = node->next;
+            node->next = nullptr;
+            Node<T>* run = node;
+            size_t i = 0;
+            // Runs already in a bin hold earlier elements, so they go left.
+            for (; bins[i]; i++){
+                run = merge_chains(bins[i], run, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = run;
+            node = next;
+        }
+        Node<T>* sorted = nullptr;
+        for (size_t i = 0; i < 64; i++){
+            if (bins[i]) sorted = sorted ? merge_chains(bins[i], sorted, comp) : bins[i];
+        }
+        // The merges only maintained next; restore prev and the ends.
+        head = sorted;
+        Node<T>* prev = nullptr;
+        for (node = sorted; node; node = node->next){
+            node->prev = prev;
+            prev = node;
+        }
+        tail = prev;
+    }
 
     // Insert a node at beginning of list
     void push_front(T value){
-        Node<T>* newNode = new Node<T>();
-        newNode->data = value;
-        newNode->next = head;
-        head = newNode;
-        length++;
+        link_before(head, std::move(value));
     }
 
     // Insert a node at end of list
     void push_back(T value){
-        Node<T>* newNode = new Node<T>();
-        newNode->data = value;
-        newNode->next = NULL;
-        if (!head) { // Set new node as head if list is empty
-            head = newNode;
-            return;
-        }
-        // Traverse to find current last node
-        Node<T>* temp = head;
-        while (temp->next){
-            temp = temp->next;
-        }
-        temp->next = newNode; // Set new node following current last node
-        length++;
+        link_before(nullptr, std::move(value));
     }
-    
-    // Insert at a specified position
+
+    // Insert at a specified position, counting from 1. Position length + 1
+    // appends.
     void insert(T value, int position){
         if (position < 1){
             std::cout << "Position should be >= 1.\n";
             return;
         }
-        if (position == 1){
-            this.push_front(value);
+        if (static_cast<size_t>(position) > count + 1){
+            std::cout << "Position out of range.\n";
             return;
         }
-
-        Node<T>* newNode = new Node<T>();
-        newNode->data = value;
-        // Traverse to specified position
-        Node<T>* temp = head;
-        for (int i = 1; i < position - 1 && temp; ++i) {
-            temp = temp->next;
+        // Walk from whichever end is closer.
+        Node<T>* before;
+        size_t index = position - 1;
+        if (index < count / 2) {
+            before = head;
+            for (size_t i = 0; i < index; i++) before = before->next;
         }
-        // Return an error if specified position is beyond the end of the list.
-        if (!temp) {
-            std::cout << "Position out of range.\n";
-            delete newNode;
-            return;
+        else {
+            before = nullptr;
+            for (size_t i = count; i > index; i--) before = before ? before->prev : tail;
         }
-        // Insert the new node at the desired position
-        newNode->next = temp->next;
-        temp->next = newNode;
-        length++;
+        link_before(before, std::move(value));
     }
-    // Return a pointer to the head of the list and remove that node from the list
+    // Removes the first element and returns it
     T pop_front(){
-        if (length < 1) {
+        if (count < 1) {
             std::cout << "List is empty.\n";
-            return;
+            return T();
         }
-
-        Node<T>* temp = head; 
-        head = head->next; 
-        return temp; 
-        length--;
+        T value = std::move(head->data);
+        remove_node(head);
+        return value;
     }
-    // Returns a pointer to last element in list and removes it from the list
+    // Removes the last element and returns it
     T pop(){
-        if (length < 1) {
+        if (count < 1) {
             std::cout << "List is empty.\n";
-            return;
-        }
-        if (!head->next) {
-            delete head;   
-            head = NULL;   
-            return;
-        }
-        // Traverse to the second-to-last node
-        Node<T>* temp = head;
-        while (temp->next->next) {
-            temp = temp->next;
+            return T();
         }
-        return temp->next; 
-        temp->next = NULL; 
-        length--;
+        T value = std::move(tail->data);
+        remove_node(tail);
+        return value;
     }
     // Removes the last element of the list from the list.
     void delete_back(){
-        if (length < 1) {
+        if (count < 1) {
             std::cout << "List is empty.\n";
             return;
         }
-        if (!head->next) {
-            delete head;   
-            head = NULL;   
+        remove_node(tail);
+    }
+    // Delete the head of the list
+    void delete_front() {
+        if (count < 1) {
+            std::cout << "List is empty.\n";
             return;
         }
-        // Traverse to the second-to-last node
-        Node<T>* temp = head;
-        while (temp->next->next) {
-            temp = temp->next;
+        remove_node(head);
+    }
+    // Removes every element. Their nodes stay in the pool for reuse.
+    void clear(){
+        while (head) remove_node(head);
+    }
+
+    T& front(){
+        return head->data;
+    }
+    T& back(){
+        return tail->data;
+    }
+    size_t size() const {
+        return count;
+    }
+    size_t length() const {
+        return count;
+    }
+    bool empty() const {
+        return count == 0;
+    }
+};
+
+/*
+    G_UnrolledList is a linked list whose nodes (blocks) each hold up to
+    BlockSize elements in a small array. Scanning it touches one block per
+    BlockSize elements, so it runs close to array speed, while inserting or
+    erasing at an iterator only shifts the elements of one block: O(BlockSize),
+    constant for a given list. A full block is split in two; a block that
+    drops under a quarter full is merged with, or refilled from, its
+    neighbour. Appending to a full block at either end of the list starts a
+    new block instead of splitting, so lists built by push_back stay packed.
+
+    The default BlockSize fills about 512 bytes per block.
+*/
+template <typename T, size_t BlockSize = (512 / sizeof(T) > 8 ? 512 / sizeof(T) : 8), typename Allocator = G_HeapAllocator>
+class G_UnrolledList {
+    static_assert(BlockSize >= 4, "G_UnrolledList needs at least 4 elements per block");
+
+    struct Block {
+        Block* next;
+        Block* prev;
+        size_t count;
+        alignas(T) unsigned char storage[sizeof(T) * BlockSize];
+
+        T* items(){ return reinterpret_cast<T*>(storage); }
+    };
+
+    Block* head;
+    Block* tail;
+    size_t total;
+    G_NodePool<Block, Allocator> pool;
+
+public:
+    // Forward iterator; Const selects the const_iterator flavour. end() is a
+    // null block.
+    template <bool Const>
+    class Iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const T*, T*>::type pointer;
+        typedef typename std::conditional<Const, const T&, T&>::type reference;
+        Iterator() : block(nullptr), index(0) {}
+        Iterator(Block* block, size_t index) : block(block), index(index) {}
+        // Lets an iterator become a const_iterator.
+        operator Iterator<true>() const { return Iterator<true>(block, index); }
+
+        reference operator*() const { return block->items()[index]; }
+        pointer operator->() const { return block->items() + index; }
+        Iterator& operator++(){
+            if (++index == block->count) {
+                block = block->next;
+                index = 0;
+            }
+            return *this;
+        }
+        Iterator operator++(int){
+            Iterator before = *this;
+            ++*this;
+            return before;
+        }
+        bool operator==(const Iterator& other) const { return block == other.block && index == other.index; }
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class G_UnrolledList;
+        Block* block;
+        size_t index;
+    };
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    G_UnrolledList() : head(nullptr), tail(nullptr), total(0) {}
+    G_UnrolledList(const G_UnrolledList& other) : head(nullptr), tail(nullptr), total(0) {
+        for (const_iterator it = other.begin(); it != other.end(); ++it) push_back(*it);
+    }
+    G_UnrolledList& operator=(const G_UnrolledList& other){
+        if (this != &other) {
+            clear();
+            for (const_iterator it = other.begin(); it != other.end(); ++it) push_back(*it);
         }
-        delete temp->next; 
-        temp->next = NULL; 
-        length--;
+        return *this;
     }
-    // Delete the head of the list
-    void delete_front() {
+    ~G_UnrolledList(){
+        clear();
+    }
+
+    iterator begin(){ return iterator(head, 0); }
+    iterator end(){ return iterator(); }
+    const_iterator begin() const { return const_iterator(head, 0); }
+    const_iterator end() const { return const_iterator(); }
+
+    // Inserts value before pos and returns an iterator to it.
+    iterator insert(const_iterator pos, T value){
+        Block* block = pos.block;
+        size_t index = pos.index;
+        if (!block) {
+            // Appending.
+            block = tail;
+            index = tail ? tail->count : 0;
+        }
+        if (!block) block = new_block_after(nullptr);
+        else if (block->count == BlockSize) {
+            if (index == BlockSize && block == tail) {
+                block = new_block_after(block);
+                index = 0;
+            }
+            else if (index == 0 && block == head) block = new_block_before(block);
+            else {
+                Block* upper = split(block);
+                if (index > block->count) {
+                    index -= block->count;
+                    block = upper;
+                }
+            }
+        }
+        T* items = block->items();
+        size_t last = block->count;
+        if (index < last) {
+            new (items + last) T(std::move(items[last - 1]));
+            std::move_backward(items + index, items + last - 1, items + last);
+            items[index] = std::move(value);
+        }
+        else new (items + index) T(std::move(value));
+        block->count++;
+        total++;
+        return iterator(block, index);
+    }
+    // Removes the element at pos and returns an iterator to the one after it.
+    iterator erase(const_iterator pos){
+        Block* block = pos.block;
+        size_t index = pos.index;
+        T* items = block->items();
+        for (size_t i = index; i + 1 < block->count; i++) items[i] = std::move(items[i + 1]);
+        items[block->count - 1].~T();
+        block->count--;
+        total--;
+        if (block->count == 0) {
+            Block* next = block->next;
+            free_block(block);
+            return iterator(next, 0);
+        }
+        if (block->count < BlockSize / 4) {
+            if (block->next) refill_from_next(block);
+            else if (block->prev && block->prev->count + block->count <= BlockSize * 3 / 4) {
+                // Fold the tail block into the one before it.
+                Block* prev = block->prev;
+                index += prev->count;
+                move_elements(block, 0, block->count, prev);
+                free_block(block);
+                block = prev;
+            }
+        }
+        if (index == block->count) return iterator(block->next, 0);
+        return iterator(block, index);
+    }
+
+    void push_back(T value){
+        insert(end(), std::move(value));
+    }
+    void push_front(T value){
+        insert(begin(), std::move(value));
+    }
+    void pop_back(){
+        if (!tail) {
+            std::cout << "List is empty.\n";
+            return;
+        }
+        erase(const_iterator(tail, tail->count - 1));
+    }
+    void pop_front(){
         if (!head) {
             std::cout << "List is empty.\n";
             return;
         }
+        erase(begin());
+    }
+
+    // Index-based access walks block by block, O(n / BlockSize).
+    iterator position(size_t index){
+        if (index >= total) return end();
+        Block* block = head;
+        while (index >= block->count) {
+            index -= block->count;
+            block = block->next;
+        }
+        return iterator(block, index);
+    }
+    T& operator[](size_t index){
+        if (index >= total){
+            std::cout << "Attempting to access an out of bounds indice.\n";
+            exit(0);
+        }
+        return *position(index);
+    }
+    // Same conventions as G_Array: index == length() appends.
+    bool insert_element_at(size_t index, T value){
+        if (index > total){
+            std::cout << "Attempted to insert at index not within list.\n";
+            return false;
+        }
+        insert(position(index), std::move(value));
+        return true;
+    }
+    bool remove_element_at(size_t index){
+        if (index >= total){
+            std::cout << "Attempted to remove index not within list.\n";
+            return false;
+        }
+        erase(position(index));
+        return true;
+    }
+
+    T& front(){ return head->items()[0]; }
+    T& back(){ return tail->items()[tail->count - 1]; }
+    size_t length() const { return total; }
+    bool empty() const { return total == 0; }
+    void clear(){
+        while (head) {
+            for (size_t i = 0; i < head->count; i++) head->items()[i].~T();
+            head->count = 0;
+            free_block(head);
+        }
+        total = 0;
+    }
 
-        Node<T>* temp = head; 
-        head = head->next; 
-        delete temp;
-        length--;  
+private:
+    Block* new_block_after(Block* before){
+        Block* block = static_cast<Block*>(pool.allocate());
+        block->count = 0;
+        block->prev = before;
+        block->next = before ? before->next : head;
+        if (block->next) block->next->prev = block;
+        else tail = block;
+        if (before) before->next = block;
+        else head = block;
+        return block;
+    }
+    Block* new_block_before(Block* after){
+        return new_block_after(after->prev);
+    }
+    // Unlinks an empty block and returns it to the pool.
+    void free_block(Block* block){
+        if (block->prev) block->prev->next = block->next;
+        else head = block->next;
+        if (block->next) block->next->prev = block->prev;
+        else tail = block->prev;
+        pool.release(block);
+    }
+    // Moves count elements of from, starting at first, onto the end of to.
+    // from's later elements slide down to fill the gap.
+    static void move_elements(Block* from, size_t first, size_t count, Block* to){
+        T* src = from->items();
+        T* dst = to->items();
+        for (size_t i = 0; i < count; i++) new (dst + to->count + i) T(std::move(src[first + i]));
+        to->count += count;
+        for (size_t i = first; i + count < from->count; i++) src[i] = std::move(src[i + count]);
+        for (size_t i = from->count - count; i < from->count; i++) src[i].~T();
+        from->count -= count;
     }
-};
\ No newline at end of file
+    // Moves the upper half of a full block into a new block after it.
+    Block* split(Block* block){
+        Block* upper = new_block_after(block);
+        move_elements(block, BlockSize / 2, BlockSize - BlockSize / 2, upper);
+        return upper;
+    }
+    // block is under a quarter full: take all of the next block if that fits
+    // comfortably, or else enough of it to even the two out.
+    void refill_from_next(Block* block){
+        Block* next = block->next;
+        size_t combined = block->count + next->count;
+        if (combined <= BlockSize * 3 / 4) {
+            move_elements(next, 0, next->count, block);
+            free_block(next);
+        }
+        else move_elements(next, 0, combined / 2 - block->count, block);
+    }
+};
@@ -0,0 +1,339 @@
+// SortBench.cpp
+// CISP 400
+// October 19, 2026
+
+/*
+    Benchmarks every G_Array sort variant, with std::sort and std::stable_sort
+    as baselines, over several input distributions and sizes. For each run it
+    reports ns per element, comparisons, element moves and heap allocations,
+    and appends a row to a CSV file so results can be compared over time.
+
+    Usage: SortBench [max size] [csv path] [run label]
+        max size   largest n to run, default 1000000 (sizes go 10, 100, ...)
+        csv path   file to append results to, default sort_bench.csv; the
+                   header row is written only when the file is new
+        run label  tags every row of this run, e.g. a commit hash; defaults
+                   to the start time
+
+    Comparisons and moves are measured in a second, instrumented run that wraps
+    every element and comparator in counters, for n up to COUNT_LIMIT. Variants
+    the wrappers can't follow (the radix paths and sort_by_key) leave those
+    columns empty.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <ctime>
+#include "../MySTL.cpp"
+
+const size_t DEFAULT_MAX_SIZE = 1000000;
+const size_t COUNT_LIMIT = 1000000; // largest n given an instrumented run
+const size_t OBJECT_SIZE_LIMIT = 10000000; // strings and records stop here
+const size_t TARGET_ELEMENTS = 2000000; // small sizes are repeated up to this
+
+// Every heap allocation in the program goes through here while a run is
+// being measured.
+std::atomic<size_t> allocations(0);
+void* operator new(size_t bytes){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/*
+    Counted wraps an element and counts its copies and moves. CountedCompare
+    wraps a comparator and counts its calls. Both use atomics so the parallel
+    sort can be instrumented too.
+*/
+std::atomic<size_t> comparisons(0);
+std::atomic<size_t> moves(0);
+
+template <typename T>
+struct Counted {
+    T value;
+    Counted() : value() {}
+    Counted(const T& v) : value(v) {}
+    Counted(const Counted& other) : value(other.value) { moves.fetch_add(1, std::memory_order_relaxed); }
+    Counted(Counted&& other) : value(std::move(other.value)) { moves.fetch_add(1, std::memory_order_relaxed); }
+    Counted& operator=(const Counted& other){
+        value = other.value;
+        moves.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+    Counted& operator=(Counted&& other){
+        value = std::move(other.value);
+        moves.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+};
+
+template <typename Compare>
+struct CountedCompare {
+    Compare comp;
+    template <typename T>
+    bool operator()(const Counted<T>& a, const Counted<T>& b) const {
+        comparisons.fetch_add(1, std::memory_order_relaxed);
+        return comp(a.value, b.value);
+    }
+};
+
+// A record as the other programs store them: a numeric key plus payload.
+struct Record {
+    int key;
+    int quantity;
+    float cost;
+    char name[20];
+};
+struct RecordLess {
+    bool operator()(const Record& a, const Record& b) const { return a.key < b.key; }
+};
+struct RecordKey {
+    int operator()(const Record& r) const { return r.key; }
+};
+// Identity projection for sort_by_key on ints and strings.
+struct SelfKey {
+    template <typename T>
+    const T& operator()(const T& v) const { return v; }
+};
+
+// Identify the run each CSV row came from.
+std::string runLabel;
+std::string runTimestamp;
+
+// One measured result, printed and written to the CSV.
+struct Result {
+    std::string variant, input;
+    size_t n;
+    double nsPerElement;
+    bool counted;
+    double comparisons, moves;
+    double allocations;
+};
+
+/*
+    The variants. Each takes a G_Array holding the input and sorts it in
+    place; the std baselines sort the same storage through data(). Descending
+    orders least to greatest (see the functor comments in MySTL), so every
+    variant produces ascending output.
+*/
+enum Variant { STD_SORT, STD_STABLE_SORT, SORT, STABLE_SORT, PARALLEL_SORT, RADIX_SORT, SORT_BY_KEY, VARIANT_COUNT };
+const char* VARIANT_NAMES[] = { "std::sort", "std::stable_sort", "sort", "stable_sort",
+                                "parallel_sort", "radix_sort", "sort_by_key" };
+
+// n is passed in because G_Array::length() logs, which would land inside the
+// timed region.
+template <typename T, typename Compare, typename Projection>
+void run_variant(Variant v, G_Array<T>& array, size_t n, Compare comp, Projection key){
+    T* first = array.data();
+    T* last = first + n;
+    switch (v){
+        case STD_SORT: std::sort(first, last, comp); break;
+        case STD_STABLE_SORT: std::stable_sort(first, last, comp); break;
+        case SORT: array.sort(comp); break;
+        case STABLE_SORT: array.stable_sort(comp); break;
+        case PARALLEL_SORT: array.parallel_sort(comp); break;
+        case RADIX_SORT:
+            if constexpr (G_Sort::radix_sortable<T>()) array.radix_sort();
+            else if constexpr (G_Sort::radix_sortable<typename std::decay<decltype(key(*first))>::type>()) {
+                array.radix_sort_by_key(key);
+            }
+            break;
+        case SORT_BY_KEY: array.sort_by_key(key, Descending<typename std::decay<decltype(key(*first))>::type>()); break;
+        default: break;
+    }
+}
+
+// True if the variant can run on T at all, and whether its comparisons and
+// moves can be counted with the Counted wrapper.
+template <typename T, typename Projection>
+bool variant_applies(Variant v){
+    if (v != RADIX_SORT) return true;
+    typedef typename std::decay<decltype(std::declval<Projection>()(std::declval<const T&>()))>::type K;
+    return G_Sort::radix_sortable<K>();
+}
+template <typename T>
+bool variant_countable(Variant v, size_t n){
+    // The radix paths don't compare, and sort_by_key compares keys rather
+    // than elements, so the wrappers would miss their work.
+    if (n > COUNT_LIMIT || v == RADIX_SORT || v == SORT_BY_KEY) return false;
+    // sort() on numbers hands off to the radix sort, which Counted can't follow.
+    if (v == SORT && std::is_arithmetic<T>::value && n >= G_Sort::RADIX_THRESHOLD) return false;
+    return true;
+}
+
+template <typename T, typename Compare>
+bool check_sorted(G_Array<T>& array, Compare comp){
+    const T* data = array.data();
+    size_t n = array.length();
+    for (size_t i = 1; i < n; i++){
+        if (comp(data[i], data[i - 1])) return false;
+    }
+    return true;
+}
+
+/*
+    Times one variant on one input: repeats the sort on fresh copies until
+    about TARGET_ELEMENTS have been sorted, then makes one instrumented run if
+    the variant can be counted.
+*/
+template <typename T, typename Compare, typename Projection>
+Result measure(Variant v, const std::string& input, const T* base, size_t n, Compare comp, Projection key){
+    Result r;
+    r.variant = VARIANT_NAMES[v];
+    r.input = input;
+    r.n = n;
+    size_t repeats = TARGET_ELEMENTS / n > 0 ? TARGET_ELEMENTS / n : 1;
+    if (repeats > 1000) repeats = 1000;
+
+    double totalNs = 0;
+    size_t totalAllocations = 0;
+    for (size_t rep = 0; rep < repeats; rep++){
+        G_Array<T> work(base, n);
+        size_t allocationsBefore = allocations.load();
+        auto begin = std::chrono::steady_clock::now();
+        run_variant(v, work, n, comp, key);
+        auto end = std::chrono::steady_clock::now();
+        totalAllocations += allocations.load() - allocationsBefore;
+        totalNs += std::chrono::duration<double, std::nano>(end - begin).count();
+        if (rep == 0 && !check_sorted(work, comp)) {
+            std::cout << "ERROR: " << r.variant << " left " << input << " n=" << n << " unsorted.\n";
+        }
+    }
+    r.nsPerElement = totalNs / (double(n) * repeats);
+    r.allocations = double(totalAllocations) / repeats;
+
+    r.counted = variant_countable<T>(v, n);
+    r.comparisons = r.moves = 0;
+    if (r.counted) {
+        Counted<T>* wrapped = new Counted<T>[n];
+        for (size_t i = 0; i < n; i++) wrapped[i].value = base[i];
+        G_Array<Counted<T>> work(wrapped, n);
+        delete[] wrapped;
+        CountedCompare<Compare> countedComp = { comp };
+        auto countedKey = [&key](const Counted<T>& c){ return key(c.value); };
+        comparisons = 0;
+        moves = 0;
+        run_variant(v, work, n, countedComp, countedKey);
+        r.comparisons = double(comparisons.load());
+        r.moves = double(moves.load());
+    }
+    return r;
+}
+
+void print_header(){
+    std::cout << std::left << std::setw(18) << "variant" << std::setw(14) << "input"
+              << std::right << std::setw(11) << "n" << std::setw(12) << "ns/elem"
+              << std::setw(12) << "cmp/elem" << std::setw(12) << "moves/elem"
+              << std::setw(10) << "allocs" << '\n';
+}
+void print_result(const Result& r){
+    std::cout << std::left << std::setw(18) << r.variant << std::setw(14) << r.input
+              << std::right << std::setw(11) << r.n << std::fixed << std::setprecision(2)
+              << std::setw(12) << r.nsPerElement;
+    if (r.counted) {
+        std::cout << std::setw(12) << r.comparisons / r.n << std::setw(12) << r.moves / r.n;
+    }
+    else std::cout << std::setw(12) << "-" << std::setw(12) << "-";
+    std::cout << std::setprecision(1) << std::setw(10) << r.allocations << '\n';
+    std::cout.unsetf(std::ios::fixed);
+}
+void write_result(std::ofstream& csv, const Result& r){
+    csv << runLabel << ',' << runTimestamp << ',' << r.variant << ',' << r.input << ',' << r.n << ',' << r.nsPerElement << ',';
+    if (r.counted) csv << r.comparisons << ',' << r.moves;
+    else csv << ',';
+    csv << ',' << r.allocations << '\n';
+}
+
+template <typename T, typename Compare, typename Projection>
+void run_input(std::ofstream& csv, const std::string& input, const T* base, size_t n, Compare comp, Projection key){
+    for (int v = 0; v < VARIANT_COUNT; v++){
+        if (!variant_applies<T, Projection>(static_cast<Variant>(v))) continue;
+        Result r = measure(static_cast<Variant>(v), input, base, n, comp, key);
+        print_result(r);
+        write_result(csv, r);
+    }
+}
+
+// The integer distributions.
+enum Distribution { RANDOM, SORTED, REVERSED, ORGAN_PIPE, FEW_UNIQUE, DISTRIBUTION_COUNT };
+const char* DISTRIBUTION_NAMES[] = { "random", "sorted", "reversed", "organ_pipe", "few_unique" };
+
+void fill_ints(int* data, size_t n, Distribution d, std::mt19937& rng){
+    for (size_t i = 0; i < n; i++){
+        switch (d){
+            case RANDOM: data[i] = static_cast<int>(rng()); break;
+            case SORTED: data[i] = static_cast<int>(i); break;
+            case REVERSED: data[i] = static_cast<int>(n - i); break;
+            case ORGAN_PIPE: data[i] = static_cast<int>(i < n / 2 ? i : n - i); break;
+            case FEW_UNIQUE: data[i] = static_cast<int>(rng() % 8); break;
+            default: break;
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    // The G_Array methods log; keep that out of the timings.
+    std::ofstream logSink("/dev/null");
+    std::clog.rdbuf(logSink.rdbuf());
+
+    size_t maxSize = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_MAX_SIZE;
+    std::string csvPath = argc > 2 ? argv[2] : "sort_bench.csv";
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    runTimestamp = stamp;
+    runLabel = argc > 3 ? argv[3] : runTimestamp;
+
+    // Only a new (or empty) file gets the header row.
+    bool fresh;
+    {
+        std::ifstream existing(csvPath, std::ios::ate);
+        fresh = !existing || existing.tellg() == 0;
+    }
+    std::ofstream csv(csvPath, std::ios::app);
+    if (!csv) {
+        std::cout << "Couldn't open " << csvPath << " for writing.\n";
+        return 1;
+    }
+    if (fresh) csv << "run,timestamp,variant,input,n,ns_per_element,comparisons,moves,allocations\n";
+
+    std::mt19937 rng(400);
+    print_header();
+    for (size_t n = 10; n <= maxSize; n *= 10){
+        int* ints = new int[n];
+        for (int d = 0; d < DISTRIBUTION_COUNT; d++){
+            fill_ints(ints, n, static_cast<Distribution>(d), rng);
+            run_input(csv, DISTRIBUTION_NAMES[d], ints, n, Descending<int>(), SelfKey());
+        }
+        delete[] ints;
+
+        if (n <= OBJECT_SIZE_LIMIT) {
+            std::string* strings = new std::string[n];
+            for (size_t i = 0; i < n; i++) strings[i] = "item_" + std::to_string(rng()) + std::string(rng() % 16, 'x');
+            run_input(csv, "strings", strings, n, Descending<std::string>(), SelfKey());
+            delete[] strings;
+
+            Record* records = new Record[n];
+            for (size_t i = 0; i < n; i++){
+                records[i].key = static_cast<int>(rng() % 100000);
+                records[i].quantity = static_cast<int>(rng() % 1000);
+                records[i].cost = (rng() % 10000) / 100.0f;
+                std::snprintf(records[i].name, sizeof(records[i].name), "record%zu", i);
+            }
+            run_input(csv, "records", records, n, RecordLess(), RecordKey());
+            delete[] records;
+        }
+        std::cout << '\n';
+        if (n > maxSize / 10) break; // the next n would overflow past maxSize
+    }
+    std::cout << "Results appended to " << csvPath << " as run " << runLabel << '\n';
+    return 0;
+}
@@ -3,6 +3,7 @@
 // Gavin Williams
 
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -356,11 +357,14 @@ int main(){
         }
         // Specification B3 - - symbol
         else if (userInput[0] == '-'){
-            std::cout << "Removing " << userInput.substr(2) << ".\n";
+            // A view of the description, so the search loop doesn't copy it
+            // once per TODO.
+            std::string_view target = std::string_view(userInput).substr(2);
+            std::cout << "Removing " << target << ".\n";
             bool foundTODO = false;
             int foundAt = -1;
             for (int i = 0; i < todoListArr.length(); i++){
-                if (todoListArr[i].description == userInput.substr(2)){
+                if (todoListArr[i].description == target){
                     foundAt = i;
                 }
             }
@@ -375,7 +379,7 @@ int main(){
                 todoListArr[foundAt] = nullTODO;
             }
             else{
-                std::cout << "Requested todo, '" << userInput.substr(2) << "' not found.\n";
+                std::cout << "Requested todo, '" << target << "' not found.\n";
             }
         }
         // Specification B2 - ? Symbol